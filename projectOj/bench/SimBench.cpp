@@ -0,0 +1,1705 @@
+// Headless simulation benchmarks.
+// Build and run from project root: python build/bench.py [benchmark name]
+
+#include "Bullet.h"
+#include "BulletPool.h"
+#include "SpatialGrid.h"
+#include "Map.h"
+#include "SimWorld.h"
+#include "JobSystem.h"
+#include "Player.h"
+#include "Match.h"
+#include "MatchServer.h"
+#include "Room.h"
+#include "Replay.h"
+#include "WorldSnapshot.h"
+#include "Rollback.h"
+#include "FastMath.h"
+#include "RandomStream.h"
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+#include <iostream>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+typedef std::chrono::steady_clock BenchClock;
+
+static double elapsedNs(BenchClock::time_point start) {
+    return std::chrono::duration<double, std::nano>(BenchClock::now() - start).count();
+}
+
+static const float benchDt = 1.0f / 60.0f;
+
+// Keeps the optimizer from discarding benchmark results
+static volatile float benchSink = 0.0f;
+
+// ----------------------------------------------------------------------------
+// Bullets: std::vector<Bullet*> vs BulletPool
+// ----------------------------------------------------------------------------
+
+// Each tick fires `perTick` bullets and expires the oldest ones, so both
+// containers run at a steady population of perTick * ticksToLive bullets.
+static void benchBullets() {
+    const int ticks = 2000;
+    const int perTickSizes[] = {8, 32, 64};
+
+    std::printf("bullets: ns/bullet/tick (steady state)\n");
+    std::printf("%10s %12s %12s\n", "live", "Bullet*", "BulletPool");
+
+    for (int perTick : perTickSizes) {
+        // Baseline: heap-allocated Bullet objects
+        std::vector<Bullet*> bullets;
+        long long bulletTicks = 0;
+        BenchClock::time_point start = BenchClock::now();
+        for (int t = 0; t < ticks; t++) {
+            for (int k = 0; k < perTick; k++) {
+                bullets.push_back(new Bullet(400.0f, 300.0f, std::cos(k * 0.1f), std::sin(k * 0.1f), k));
+            }
+            for (Bullet* bullet : bullets) {
+                bullet->update(benchDt);
+            }
+            bulletTicks += bullets.size();
+            bullets.erase(
+                std::remove_if(bullets.begin(), bullets.end(),
+                    [](Bullet* bullet) {
+                        if (!bullet->active) {
+                            delete bullet;
+                            return true;
+                        }
+                        return false;
+                    }),
+                bullets.end());
+        }
+        double vectorNs = elapsedNs(start) / bulletTicks;
+        size_t live = bullets.size();
+        for (Bullet* bullet : bullets) {
+            benchSink = benchSink + bullet->x;
+            delete bullet;
+        }
+
+        // Pooled structure of arrays
+        BulletPool pool(BulletPool::DEFAULT_CAPACITY * 4);
+        long long poolTicks = 0;
+        start = BenchClock::now();
+        for (int t = 0; t < ticks; t++) {
+            for (int k = 0; k < perTick; k++) {
+                pool.spawn(400.0f, 300.0f, std::cos(k * 0.1f), std::sin(k * 0.1f), k);
+            }
+            pool.update(benchDt);
+            poolTicks += pool.count;
+            pool.compact();
+        }
+        double poolNs = elapsedNs(start) / poolTicks;
+        benchSink = benchSink + pool.x[0];
+
+        std::printf("%10zu %12.2f %12.2f\n", live, vectorNs, poolNs);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Bullet integration: BulletPool::update (SIMD) vs updateScalar
+// ----------------------------------------------------------------------------
+
+static void benchIntegrate() {
+    const int sizes[] = {1000, 10000, 100000};
+    const int ticks = 200;
+
+    std::printf("integrate: ns/bullet/tick, positions + lifetimes + expiry mask\n");
+    std::printf("%10s %12s %12s\n", "bullets", "scalar", "simd");
+
+    for (int n : sizes) {
+        BulletPool pool(n);
+        pool.maxLifetime = 1e9f;  // Measure integration only, nothing expires
+        for (int i = 0; i < n; i++) {
+            pool.spawn(400.0f, 300.0f, std::cos(i * 0.01f), std::sin(i * 0.01f), i);
+        }
+
+        BenchClock::time_point start = BenchClock::now();
+        for (int t = 0; t < ticks; t++) {
+            pool.updateScalar(benchDt);
+        }
+        double scalarNs = elapsedNs(start) / ((double)n * ticks);
+
+        start = BenchClock::now();
+        for (int t = 0; t < ticks; t++) {
+            pool.update(benchDt);
+        }
+        double simdNs = elapsedNs(start) / ((double)n * ticks);
+        benchSink = benchSink + pool.x[n - 1];
+
+        std::printf("%10d %12.3f %12.3f\n", n, scalarNs, simdNs);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Bullet-vs-player hits: brute force vs SpatialGrid broadphase
+// ----------------------------------------------------------------------------
+
+// Queries from a few cells up to past the whole table must return every
+// point inside the box exactly once, however many cells share a bucket.
+static bool queriesReturnEachOnce() {
+    std::mt19937 rng(1983);
+    std::uniform_real_distribution<float> coord(0.0f, 4000.0f);
+    std::vector<float> px(300), py(300);
+    SpatialGrid grid(64.0f, 64);    // Small table so wide boxes wrap it many times
+    grid.begin();
+    for (int p = 0; p < 300; p++) {
+        px[p] = coord(rng);
+        py[p] = coord(rng);
+        grid.insert(p, px[p], py[p]);
+    }
+    grid.finish();
+
+    const float radii[] = {10.0f, 100.0f, 300.0f, 1000.0f, 5000.0f};
+    std::vector<int> candidates;
+    for (float radius : radii) {
+        for (int q = 0; q < 50; q++) {
+            float x = coord(rng), y = coord(rng);
+            candidates.clear();
+            grid.query(x, y, radius, candidates);
+
+            std::vector<int> seen(300, 0);
+            for (int p : candidates) {
+                if (seen[p]++) return false;
+            }
+            for (int p = 0; p < 300; p++) {
+                bool inside = std::fabs(px[p] - x) <= radius && std::fabs(py[p] - y) <= radius;
+                if (inside && !seen[p]) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Players and bullets scattered over a 2000x2000 arena; each pass counts the
+// first player hit by every bullet without changing any state.
+static void benchHits() {
+    const int playerCounts[] = {4, 16, 50, 100, 200};
+    const int bulletCounts[] = {50, 500, 5000};
+    const float arena = 2000.0f;
+    const float playerRadius = 10.0f;
+    const float bulletRadius = 4.0f;
+    const int passes = 50;
+
+    std::mt19937 rng(1971);
+    std::uniform_real_distribution<float> coord(0.0f, arena);
+
+    std::printf("hits: us/tick, brute force vs grid (build + queries)\n");
+    std::printf("%8s %8s %12s %12s\n", "players", "bullets", "brute", "grid");
+
+    for (int players : playerCounts) {
+        std::vector<float> px(players), py(players);
+        for (int p = 0; p < players; p++) {
+            px[p] = coord(rng);
+            py[p] = coord(rng);
+        }
+
+        for (int bullets : bulletCounts) {
+            std::vector<float> bx(bullets), by(bullets);
+            for (int b = 0; b < bullets; b++) {
+                bx[b] = coord(rng);
+                by[b] = coord(rng);
+            }
+
+            // Brute force: every bullet against every player, sqrt per pair
+            int bruteHits = 0;
+            BenchClock::time_point start = BenchClock::now();
+            for (int pass = 0; pass < passes; pass++) {
+                for (int b = 0; b < bullets; b++) {
+                    for (int p = 0; p < players; p++) {
+                        float dx = bx[b] - px[p];
+                        float dy = by[b] - py[p];
+                        if (std::sqrt(dx * dx + dy * dy) < playerRadius + bulletRadius) {
+                            bruteHits++;
+                            break;
+                        }
+                    }
+                }
+            }
+            double bruteUs = elapsedNs(start) / 1000.0 / passes;
+
+            // Grid: rebuild each pass, squared-distance narrowphase
+            SpatialGrid grid;
+            std::vector<int> candidates;
+            int gridHits = 0;
+            start = BenchClock::now();
+            for (int pass = 0; pass < passes; pass++) {
+                grid.begin();
+                for (int p = 0; p < players; p++) {
+                    grid.insert(p, px[p], py[p]);
+                }
+                grid.finish();
+
+                const float reach = playerRadius + bulletRadius;
+                for (int b = 0; b < bullets; b++) {
+                    candidates.clear();
+                    grid.query(bx[b], by[b], reach, candidates);
+                    for (int p : candidates) {
+                        float dx = bx[b] - px[p];
+                        float dy = by[b] - py[p];
+                        if (dx * dx + dy * dy < reach * reach) {
+                            gridHits++;
+                            break;
+                        }
+                    }
+                }
+            }
+            double gridUs = elapsedNs(start) / 1000.0 / passes;
+
+            std::printf("%8d %8d %12.2f %12.2f%s\n", players, bullets, bruteUs, gridUs,
+                        bruteHits == gridHits ? "" : "  (hit count mismatch!)");
+        }
+    }
+    std::printf("wide queries: %s\n", queriesReturnEachOnce() ? "each point once" : "DUPLICATES OR MISSES");
+}
+
+// ----------------------------------------------------------------------------
+// Map queries: exact obstacle scan vs distance field
+// ----------------------------------------------------------------------------
+
+// Walk a circle out along a corridor exactly two radii wide, in steps the
+// size of a player's tick, starting inside it. The center line runs between
+// two rows of field samples, so the field reads a little under the radius
+// there and its gradient cancels: movement has to keep going without a
+// normal to slide on.
+static bool crossesCorridor(bool fixed) {
+    const float radius = 15.0f;
+    const float step = 2.0f;
+    const float centerY = 301.0f;   // Samples are every FIELD_CELL_SIZE = 2 units
+    Map map(800.0f, 600.0f);
+    map.obstacles.erase(map.obstacles.begin() + 4, map.obstacles.end());  // Keep the borders
+    map.obstacles.push_back(Obstacle(400.0f, centerY - radius - 25.0f, 400.0f, 50.0f));
+    map.obstacles.push_back(Obstacle(400.0f, centerY + radius + 25.0f, 400.0f, 50.0f));
+    map.buildCollisionData();
+
+    float x = 250.0f, y = centerY;      // The corridor runs from x = 200 to 600
+    Fixed fixedX = toFixed(x), fixedY = toFixed(y);
+    for (int t = 0; t < 250; t++) {
+        if (fixed) {
+            map.moveCircleFixed(fixedX, fixedY, toFixed(radius), toFixed(step), 0);
+        } else {
+            map.moveCircle(x, y, radius, step, 0.0f);
+        }
+    }
+    if (fixed) {
+        x = fromFixed(fixedX);
+        y = fromFixed(fixedY);
+    }
+    return x > 600.0f + radius && std::fabs(y - centerY) < 1.0f;
+}
+
+// Push a circle diagonally into the bottom wall: it should slide along it at
+// the full horizontal speed instead of stopping on contact
+static bool slidesAlongWall(bool fixed) {
+    const float radius = 15.0f;
+    const Map* map = Map::shared(800.0f, 600.0f);
+    float x = 400.0f, y = 20.0f + radius + 1.0f;  // Just above the wall
+    Fixed fixedX = toFixed(x), fixedY = toFixed(y);
+    for (int t = 0; t < 20; t++) {
+        if (fixed) {
+            map->moveCircleFixed(fixedX, fixedY, toFixed(radius), 2 * FIXED_ONE, -2 * FIXED_ONE);
+        } else {
+            map->moveCircle(x, y, radius, 2.0f, -2.0f);
+        }
+    }
+    if (fixed) {
+        x = fromFixed(fixedX);
+        y = fromFixed(fixedY);
+    }
+    return std::fabs(x - 440.0f) < 0.1f && std::fabs(y - (20.0f + radius)) < 0.1f;
+}
+
+// Random walks over the default map: time per moveCircle and the deepest
+// any circle ended up inside an obstacle, measured against the exact shapes
+static void benchMoves(bool fixed) {
+    const int walkers = 1000;
+    const int ticks = 200;
+    const float radius = 15.0f;
+    const float speed = 3.0f;
+    const Map* map = Map::shared(800.0f, 600.0f);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coordX(0.0f, map->width);
+    std::uniform_real_distribution<float> coordY(0.0f, map->height);
+    std::uniform_real_distribution<float> turn(0.0f, 6.2831853f);
+    std::vector<float> xs(walkers), ys(walkers), dirX(walkers), dirY(walkers);
+    std::vector<Fixed> fixedXs(walkers), fixedYs(walkers);
+    for (int w = 0; w < walkers; w++) {
+        do {
+            xs[w] = coordX(rng);
+            ys[w] = coordY(rng);
+        } while (!map->isValidSpawnPosition(xs[w], ys[w], radius));
+        fixedXs[w] = toFixed(xs[w]);
+        fixedYs[w] = toFixed(ys[w]);
+    }
+
+    double totalNs = 0.0;
+    float deepest = 0.0f;
+    for (int t = 0; t < ticks; t++) {
+        if (t % 20 == 0) {
+            for (int w = 0; w < walkers; w++) {
+                float angle = turn(rng);
+                dirX[w] = std::cos(angle) * speed;
+                dirY[w] = std::sin(angle) * speed;
+            }
+        }
+        BenchClock::time_point start = BenchClock::now();
+        for (int w = 0; w < walkers; w++) {
+            if (fixed) {
+                map->moveCircleFixed(fixedXs[w], fixedYs[w], toFixed(radius), toFixed(dirX[w]), toFixed(dirY[w]));
+            } else {
+                map->moveCircle(xs[w], ys[w], radius, dirX[w], dirY[w]);
+            }
+        }
+        totalNs += elapsedNs(start);
+        for (int w = 0; w < walkers; w++) {
+            float x = fixed ? fromFixed(fixedXs[w]) : xs[w];
+            float y = fixed ? fromFixed(fixedYs[w]) : ys[w];
+            deepest = std::max(deepest, radius - map->distanceLinear(x, y));
+        }
+    }
+    std::printf("%6s %12.1f %12.3f\n", fixed ? "fixed" : "float", totalNs / ((double)walkers * ticks), deepest);
+}
+
+static void benchMap() {
+    const int queries = 1000000;
+    const float radius = 10.0f;
+
+    Map map(800.0f, 600.0f);
+    std::mt19937 rng(1971);
+    std::uniform_real_distribution<float> coordX(0.0f, map.width);
+    std::uniform_real_distribution<float> coordY(0.0f, map.height);
+    std::vector<float> xs(queries), ys(queries);
+    for (int i = 0; i < queries; i++) {
+        xs[i] = coordX(rng);
+        ys[i] = coordY(rng);
+    }
+
+    std::printf("map: ns/circle query, %d obstacles, %dx%d field\n",
+                (int)map.obstacles.size(), map.distanceField.columns, map.distanceField.rows);
+    std::printf("%12s %12s %12s %10s %8s\n", "exact scan", "field", "field batch", "disagree", "batch");
+
+    int exactHits = 0;
+    BenchClock::time_point start = BenchClock::now();
+    for (int i = 0; i < queries; i++) {
+        exactHits += map.checkCollisionLinear(xs[i], ys[i], radius) ? 1 : 0;
+    }
+    double exactNs = elapsedNs(start) / queries;
+
+    int fieldHits = 0;
+    start = BenchClock::now();
+    for (int i = 0; i < queries; i++) {
+        fieldHits += map.checkCollision(xs[i], ys[i], radius) ? 1 : 0;
+    }
+    double fieldNs = elapsedNs(start) / queries;
+
+    std::vector<unsigned int> mask;
+    start = BenchClock::now();
+    map.checkCollisionBatch(xs.data(), ys.data(), queries, radius, mask);
+    double batchNs = elapsedNs(start) / queries;
+    bool batchSame = true;
+    for (int i = 0; i < queries; i++) {
+        bool hit = (mask[i / 32] >> (i % 32)) & 1u;
+        batchSame = batchSame && hit == map.checkCollision(xs[i], ys[i], radius);
+    }
+
+    // Circles within a fraction of a cell of a surface may be answered
+    // differently by the field; the batch must agree with checkCollision()
+    std::printf("%12.2f %12.2f %12.2f %10d %8s\n", exactNs, fieldNs, batchNs, std::abs(exactHits - fieldHits),
+                batchSame ? "same" : "DIFFER");
+
+    // Baking the field, the spawn points and the rest of the collision data
+    for (int scale = 1; scale <= 2; scale++) {
+        Map baked(800.0f * scale, 600.0f * scale);
+        BenchClock::time_point bakeStart = BenchClock::now();
+        baked.buildCollisionData();
+        std::printf("bake %4.0fx%-4.0f %d obstacles: %.1f ms\n", baked.width, baked.height,
+                    (int)baked.obstacles.size(), elapsedNs(bakeStart) / 1e6);
+    }
+    std::printf("corridor exactly two radii wide: float %s, fixed %s\n",
+                crossesCorridor(false) ? "passes" : "STUCK", crossesCorridor(true) ? "passes" : "STUCK");
+    std::printf("diagonal into a wall: float %s, fixed %s\n",
+                slidesAlongWall(false) ? "slides" : "STUCK", slidesAlongWall(true) ? "slides" : "STUCK");
+
+    std::printf("moveCircle random walks (sweep and slide)\n%6s %12s %12s\n", "mode", "ns/move", "max overlap");
+    benchMoves(false);
+    benchMoves(true);
+}
+
+// ----------------------------------------------------------------------------
+// Threads: the same match on 1, 4 and 16 threads must end in the same state
+// ----------------------------------------------------------------------------
+
+// Scripted inputs that only depend on the tick and the player, never on timing
+// Movement from the low bits of a hash: never both up and down, or left and right
+static unsigned char scriptedButtons(unsigned int bits) {
+    unsigned char buttons = 0;
+    if (bits & 1) buttons |= InputCmd::UP;
+    else if (bits & 2) buttons |= InputCmd::DOWN;
+    if (bits & 4) buttons |= InputCmd::LEFT;
+    else if (bits & 8) buttons |= InputCmd::RIGHT;
+    return buttons;
+}
+
+static void scriptedInputs(const SimWorld& world, std::vector<PlayerInput>& inputs) {
+    inputs.clear();
+    for (const PlayerBody& player : world.entities.bodies) {
+        if (!player.isAlive) continue;
+        unsigned int bits = (unsigned int)player.id * 2654435761u ^ (world.tick / 30) * 40503u;
+        PlayerInput input;
+        input.playerId = player.id;
+        input.buttons = scriptedButtons(bits) | InputCmd::AIM;
+        input.aim = (unsigned short)(bits >> 8);
+        if ((world.tick + player.id) % 30 == 0) {
+            input.buttons |= InputCmd::FIRE;
+        }
+        inputs.push_back(input);
+    }
+}
+
+// Whole-unit positions from raw mt19937 output (the distributions are not
+// specified bit-for-bit across standard libraries), checked with the
+// fixed-point map query, so every build places players identically
+static void placePlayers(SimWorld& world, int players) {
+    std::mt19937 rng(1971);
+    unsigned int rangeX = (unsigned int)world.width - 80;
+    unsigned int rangeY = (unsigned int)world.height - 80;
+    for (int p = 0; p < players; p++) {
+        float x, y;
+        do {
+            x = 40.0f + (float)(rng() % rangeX);
+            y = 40.0f + (float)(rng() % rangeY);
+        } while (world.gameMap->checkCollisionFixed(toFixed(x), toFixed(y), 15 * FIXED_ONE));
+        world.addPlayer(PlayerBody(p + 1, x, y));
+    }
+}
+
+static void benchThreads() {
+    const int threadCounts[] = {1, 4, 16};
+    const int players = 2048;
+    const int ticks = 600;
+
+    std::printf("threads: %d players, %d ticks, hash of the final state\n", players, ticks);
+    std::printf("%8s %12s %10s %8s %20s\n", "threads", "us/tick", "bullets", "alive", "state hash");
+
+    // Kill messages would swamp the output
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+
+    unsigned long long reference = 0;
+    bool allMatch = true;
+    for (int threads : threadCounts) {
+        JobSystem jobs(threads);
+        SimWorld world(4000.0f, 3000.0f);
+        world.jobs = &jobs;
+
+        placePlayers(world, players);
+
+        // Combine per-tick hashes so a divergence anywhere in the match shows up
+        std::vector<PlayerInput> inputs;
+        unsigned long long hash = 0;
+        int peakBullets = 0;
+        BenchClock::time_point start = BenchClock::now();
+        for (int t = 0; t < ticks; t++) {
+            scriptedInputs(world, inputs);
+            world.step(inputs);
+            hash = hash * 31 + world.stateHash();
+            peakBullets = std::max(peakBullets, world.bullets.count);
+        }
+        double tickUs = elapsedNs(start) / 1000.0 / ticks;
+
+        if (threads == threadCounts[0]) reference = hash;
+        allMatch = allMatch && hash == reference;
+        std::printf("%8d %12.1f %10d %8d %20llx%s\n", threads, tickUs, peakBullets, world.aliveCount(), hash,
+                    hash == reference ? "" : "  (differs from 1 thread!)");
+    }
+
+    std::cout.rdbuf(coutBuffer);
+    std::printf("%s\n", allMatch ? "deterministic: all thread counts match" : "NOT DETERMINISTIC");
+}
+
+// ----------------------------------------------------------------------------
+// Matches: many independent matches in one process
+// ----------------------------------------------------------------------------
+
+static void benchMatches() {
+    const int matchCounts[] = {1, 8, 32, 64};
+    const int playersPerMatch = 16;
+    const int ticks = 300;
+    int threads = (int)std::thread::hardware_concurrency();
+
+    std::printf("matches: %d players each, %d ticks, %d thread(s)\n", playersPerMatch, ticks, threads);
+    std::printf("%8s %14s %16s %16s %8s %14s\n", "matches", "us/server tick", "avg ms/match", "max ms/match", "active",
+                "start us/match");
+
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+    JobSystem jobs(threads);
+
+    for (int matchCount : matchCounts) {
+        // Every match gets its own roster from a shared lobby
+        EntityStore lobby;
+        std::vector<Room*> rooms;
+        MatchServer server(800.0f, 600.0f, &jobs);
+        BenchClock::time_point start = BenchClock::now();
+        for (int m = 0; m < matchCount; m++) {
+            Room* room = new Room(m + 1, "bench", playersPerMatch);
+            for (int p = 0; p < playersPerMatch; p++) {
+                room->addPlayer(lobby.create(PlayerBody(p + 1, 0.0f, 0.0f)));
+            }
+            rooms.push_back(room);
+            server.createMatch(room, lobby);
+        }
+        double startUs = elapsedNs(start) / 1000.0 / matchCount;
+
+        start = BenchClock::now();
+        for (int t = 0; t < ticks; t++) {
+            for (Match* match : server.matches) {
+                scriptedInputs(*match->world, match->pendingInputs);
+            }
+            server.tick();
+        }
+        double tickUs = elapsedNs(start) / 1000.0 / ticks;
+
+        double avgMs = 0.0, maxMs = 0.0;
+        for (const Match* match : server.matches) {
+            avgMs += match->averageTickMs() / matchCount;
+            maxMs = std::max(maxMs, match->maxTickMs);
+        }
+        std::printf("%8d %14.1f %16.4f %16.4f %8d %14.1f\n", matchCount, tickUs, avgMs, maxMs, server.activeCount(),
+                    startUs);
+
+        for (Room* room : rooms) {
+            delete room;
+        }
+    }
+
+    std::cout.rdbuf(coutBuffer);
+}
+
+// ----------------------------------------------------------------------------
+// Lockstep: float vs deterministic fixed-point mode
+// ----------------------------------------------------------------------------
+
+// The deterministic hash must be the same for every compiler and flag set;
+// compare it between builds (e.g. -O0, -O2, -O2 -march=native)
+static void benchLockstep() {
+    const int players = 512;
+    const int ticks = 600;
+
+    std::printf("lockstep: %d players, %d ticks\n", players, ticks);
+    std::printf("%14s %12s %8s %20s\n", "mode", "us/tick", "alive", "state hash");
+
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+    for (int mode = 0; mode < 2; mode++) {
+        SimWorld world(1600.0f, 1200.0f);
+        placePlayers(world, players);
+        world.setDeterministic(mode == 1);
+
+        std::vector<PlayerInput> inputs;
+        unsigned long long hash = 0;
+        BenchClock::time_point start = BenchClock::now();
+        for (int t = 0; t < ticks; t++) {
+            scriptedInputs(world, inputs);
+            world.step(inputs);
+            hash = hash * 31 + world.stateHash();
+        }
+        double tickUs = elapsedNs(start) / 1000.0 / ticks;
+
+        std::printf("%14s %12.1f %8d %20llx\n", mode == 1 ? "deterministic" : "float",
+                    tickUs, world.aliveCount(), hash);
+    }
+    std::cout.rdbuf(coutBuffer);
+}
+
+// ----------------------------------------------------------------------------
+// Replay: record a 10-minute match, then re-simulate it from the input log
+// ----------------------------------------------------------------------------
+
+static void benchReplay() {
+    const int players = 8;
+    const int tickRate = 60;
+    const int ticks = 10 * 60 * tickRate;
+
+    std::printf("replay: %d players, %d ticks (10 min at %d Hz)\n", players, ticks, tickRate);
+    std::printf("%14s %8s %10s %12s %12s %8s\n", "mode", "ticks", "bytes", "record ms", "replay ms", "match");
+
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+    for (int mode = 0; mode < 2; mode++) {
+        EntityStore lobby;
+        Room room(1, "bench", players);
+        for (int p = 0; p < players; p++) {
+            room.addPlayer(lobby.create(PlayerBody(p + 1, 400.0f, 300.0f)));
+        }
+
+        Replay replay;
+        Match match(1, &room, lobby, 800.0f, 600.0f);
+        match.world->setTickRate(tickRate);
+        match.world->setDeterministic(mode == 1);
+        match.world->seed = 1971;
+        match.recording = &replay;
+        match.start();
+
+        // Everyone fires now and then until two players are left; those two
+        // only move, so the match runs the full ten minutes
+        BenchClock::time_point start = BenchClock::now();
+        for (int t = 0; t < ticks && match.isActive(); t++) {
+            scriptedInputs(*match.world, match.pendingInputs);
+            bool shooting = match.world->aliveCount() > 2;
+            for (PlayerInput& input : match.pendingInputs) {
+                input.buttons &= ~InputCmd::FIRE;
+                if (shooting && (match.world->tick + input.playerId * 75) % 600 == 0) {
+                    input.buttons |= InputCmd::FIRE;
+                }
+            }
+            match.update();
+        }
+        if (match.isActive()) {
+            replay.finish(*match.world);
+        }
+        double recordMs = elapsedNs(start) / 1e6;
+
+        std::vector<unsigned char> bytes;
+        replay.serialize(bytes);
+        Replay loaded;
+        loaded.deserialize(bytes.data(), bytes.size());
+
+        // The world (and its map) is built before timing, as the recording's was
+        ReplayPlayer player(loaded);
+        start = BenchClock::now();
+        player.runToEnd();
+        double replayMs = elapsedNs(start) / 1e6;
+
+        std::printf("%14s %8u %10u %12.1f %12.1f %8s\n", mode == 1 ? "deterministic" : "float",
+                    replay.tickCount, (unsigned int)bytes.size(), recordMs, replayMs,
+                    player.matchesRecording() ? "yes" : "NO");
+    }
+    std::cout.rdbuf(coutBuffer);
+}
+
+// ----------------------------------------------------------------------------
+// Snapshot: capture / restore a whole world, as rollback would every tick
+// ----------------------------------------------------------------------------
+
+static void benchSnapshot() {
+    const int players = 100;
+    const int bulletCounts[] = {0, 1000, 5000};
+    const int iterations = 2000;
+
+    std::printf("snapshot: %d players, %d iterations\n", players, iterations);
+    std::printf("%8s %10s %12s %12s %8s\n", "bullets", "bytes", "capture us", "restore us", "exact");
+
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+    for (int bulletCount : bulletCounts) {
+        SimWorld world(1600.0f, 1200.0f);
+        world.bullets = BulletPool(8192);
+        placePlayers(world, players);
+        for (int b = 0; b < bulletCount; b++) {
+            const PlayerBody& shooter = world.entities.bodies[b % players];
+            world.bullets.spawn(shooter.x, shooter.y, std::cos(b * 0.37f), std::sin(b * 0.37f), shooter.id, 300.0f);
+        }
+
+        SnapshotRing ring(16, players, 8192);
+        BenchClock::time_point start = BenchClock::now();
+        for (int i = 0; i < iterations; i++) {
+            ring.save(world);
+        }
+        double captureUs = elapsedNs(start) / 1000.0 / iterations;
+
+        start = BenchClock::now();
+        for (int i = 0; i < iterations; i++) {
+            ring.restore(world, world.tick);
+        }
+        double restoreUs = elapsedNs(start) / 1000.0 / iterations;
+
+        // Run ahead, roll back, and run the same ticks again: states must agree
+        std::vector<PlayerInput> inputs;
+        ring.save(world);
+        unsigned int rollbackTick = world.tick;
+        for (int t = 0; t < 10; t++) {
+            scriptedInputs(world, inputs);
+            world.step(inputs);
+        }
+        unsigned long long ahead = world.stateHash();
+        ring.restore(world, rollbackTick);
+        for (int t = 0; t < 10; t++) {
+            scriptedInputs(world, inputs);
+            world.step(inputs);
+        }
+        bool exact = world.stateHash() == ahead;
+
+        std::printf("%8d %10u %12.2f %12.2f %8s\n", bulletCount, (unsigned int)ring.find(rollbackTick)->size,
+                    captureUs, restoreUs, exact ? "yes" : "NO");
+    }
+    std::cout.rdbuf(coutBuffer);
+}
+
+// ----------------------------------------------------------------------------
+// Rollback: every remote input arrives late and was mispredicted
+// ----------------------------------------------------------------------------
+
+// Input that only depends on the player and the tick, and changes every tick
+static PlayerInput peerInput(int playerId, unsigned int tick) {
+    unsigned int bits = (unsigned int)playerId * 2654435761u ^ tick * 40503u;
+    PlayerInput input;
+    input.playerId = playerId;
+    input.tick = tick;
+    input.buttons = scriptedButtons(bits) | InputCmd::AIM;
+    input.aim = (unsigned short)(bits >> 8);
+    if ((tick + playerId) % 30 == 0) {
+        input.buttons |= InputCmd::FIRE;
+    }
+    return input;
+}
+
+static void benchRollback() {
+    const int playerCounts[] = {16, 100};
+    const int delays[] = {8, 10};
+    const int ticks = 600;
+
+    std::printf("rollback: %d ticks, remote inputs arrive <delay> ticks late and all differ from the prediction\n", ticks);
+    std::printf("%8s %6s %12s %14s %14s %8s\n", "players", "delay", "us/advance", "avg rollback ms", "max rollback ms", "exact");
+
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+    for (int players : playerCounts) {
+        for (int delay : delays) {
+            SimWorld world(1600.0f, 1200.0f);
+            placePlayers(world, players);
+            world.setDeterministic(true);
+            std::vector<int> roster;
+            for (const PlayerBody& body : world.entities.bodies) {
+                roster.push_back(body.id);
+            }
+            RollbackSession session(&world, roster[0], roster);
+
+            double rollbackMs = 0.0;
+            BenchClock::time_point start = BenchClock::now();
+            for (unsigned int t = 0; t < (unsigned int)ticks; t++) {
+                if (t >= (unsigned int)delay) {
+                    for (size_t c = 1; c < roster.size(); c++) {
+                        session.addRemoteInput(peerInput(roster[c], t - delay));
+                    }
+                }
+                session.addLocalInput(peerInput(roster[0], t));
+                session.advance();
+                rollbackMs += session.lastRollbackMs;
+                session.lastRollbackMs = 0.0;
+            }
+            double advanceUs = elapsedNs(start) / 1000.0 / ticks;
+
+            // Deliver the rest; the snapshot of the present must match a world that knew every input
+            for (unsigned int t = ticks - delay; t < (unsigned int)ticks; t++) {
+                for (size_t c = 1; c < roster.size(); c++) {
+                    session.addRemoteInput(peerInput(roster[c], t));
+                }
+            }
+            session.addLocalInput(peerInput(roster[0], ticks));
+            session.advance();
+            session.snapshots.restore(world, ticks);
+            unsigned long long rolledBack = world.stateHash();
+
+            SimWorld reference(1600.0f, 1200.0f);
+            placePlayers(reference, players);
+            reference.setDeterministic(true);
+            std::vector<PlayerInput> inputs;
+            for (unsigned int t = 0; t < (unsigned int)ticks; t++) {
+                inputs.clear();
+                for (int id : roster) {
+                    inputs.push_back(peerInput(id, t));
+                }
+                reference.step(inputs);
+            }
+            bool exact = reference.stateHash() == rolledBack;
+
+            std::printf("%8d %6d %12.1f %14.3f %14.3f %8s\n", players, delay, advanceUs,
+                        session.rollbacks > 0 ? rollbackMs / session.rollbacks : 0.0,
+                        session.maxRollbackMs, exact ? "yes" : "NO");
+        }
+    }
+    std::cout.rdbuf(coutBuffer);
+}
+
+// ----------------------------------------------------------------------------
+// Lag compensation: position history cost and rewound hit tests
+// ----------------------------------------------------------------------------
+
+// A target runs right past a shot fired at where a lagged shooter saw it
+// delay ticks ago. Returns whether the rewound test hits and the plain one misses.
+static bool rewoundShotHits(float delay) {
+    SimWorld world(1600.0f, 1200.0f);
+
+    // Open stretch of floor the target can cross without touching a wall
+    float startX = 0.0f, startY = 0.0f;
+    for (float y = 100.0f; y < 1100.0f && startX == 0.0f; y += 25.0f) {
+        for (float x = 100.0f; x < 1400.0f; x += 25.0f) {
+            bool clear = true;
+            for (float along = 0.0f; along <= 100.0f && clear; along += 5.0f) {
+                clear = !world.gameMap->checkCollisionFixed(toFixed(x + along), toFixed(y), 15 * FIXED_ONE);
+            }
+            if (clear) {
+                startX = x;
+                startY = y;
+                break;
+            }
+        }
+    }
+    world.addPlayer(PlayerBody(1, startX, startY - 200.0f));
+    world.addPlayer(PlayerBody(2, startX, startY));
+
+    std::vector<PlayerInput> inputs(1);
+    inputs[0].playerId = 2;
+    inputs[0].buttons = InputCmd::RIGHT;
+    std::vector<float> pastX;
+    for (int t = 0; t < 30; t++) {
+        world.step(inputs);
+        pastX.push_back(world.entities.bodies[world.findPlayer(2)].x);
+    }
+
+    // Where the shooter saw the target, between two recorded ticks
+    int whole = (int)delay;
+    float fraction = delay - whole;
+    int newer = (int)pastX.size() - 1 - whole;
+    float seenX = pastX[newer] + (pastX[newer - 1] - pastX[newer]) * fraction;
+
+    int i = world.bullets.spawn(seenX, startY, 0.0f, 1.0f, 1, 0.0f);
+    world.buildPlayerGrid();
+    std::vector<int> candidates;
+    world.tick--;   // findBulletHit runs within the last step's tick
+    bool plainMiss = world.findBulletHit(i, 14.0f, 3.0f, candidates) == -1;
+    world.bullets.rewind[i] = toFixed(delay);
+    bool rewoundHit = world.findBulletHit(i, 14.0f, 3.0f, candidates) == 1;
+    return plainMiss && rewoundHit;
+}
+
+static void benchLagComp() {
+    const int playerCounts[] = {100, 1000};
+    const int bulletCount = 2000;
+    const float delays[] = {0.0f, 6.0f};    // 6 ticks = 100 ms at 60 Hz
+    const int iterations = 500;
+
+    std::printf("lagcomp: %d-tick history, %d bullets, hit tests with every bullet rewound by <delay> ticks\n",
+                PositionHistory::DEFAULT_TICKS, bulletCount);
+    std::printf("%8s %10s %12s %6s %12s\n", "players", "bytes", "record us", "delay", "hits us");
+
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+    for (int players : playerCounts) {
+        SimWorld world(1600.0f, 1200.0f);
+        placePlayers(world, players);
+        std::vector<PlayerInput> inputs;
+        for (int t = 0; t < PositionHistory::DEFAULT_TICKS; t++) {
+            scriptedInputs(world, inputs);
+            for (PlayerInput& input : inputs) {
+                input.buttons &= ~InputCmd::FIRE;
+            }
+            world.step(inputs);
+        }
+
+        BenchClock::time_point start = BenchClock::now();
+        for (int n = 0; n < iterations; n++) {
+            world.history.record(world.tick - 1, world.entities, false);
+        }
+        double recordUs = elapsedNs(start) / 1000.0 / iterations;
+
+        for (int b = 0; b < bulletCount; b++) {
+            const PlayerBody& shooter = world.entities.bodies[b % players];
+            world.bullets.spawn(shooter.x, shooter.y, std::cos(b * 0.37f), std::sin(b * 0.37f), shooter.id, 300.0f);
+        }
+        world.tick--;
+        world.buildPlayerGrid();
+        std::vector<int> candidates;
+
+        for (float delay : delays) {
+            for (int b = 0; b < bulletCount; b++) {
+                world.bullets.rewind[b] = toFixed(delay);
+            }
+            int hits = 0;
+            start = BenchClock::now();
+            for (int n = 0; n < iterations; n++) {
+                for (int b = 0; b < bulletCount; b++) {
+                    hits += world.findBulletHit(b, 14.0f, 3.0f, candidates) != -1;
+                }
+            }
+            double hitsUs = elapsedNs(start) / 1000.0 / iterations;
+            benchSink = benchSink + (float)hits;
+
+            std::printf("%8d %10u %12.2f %6.0f %12.1f\n", players, (unsigned int)world.history.memoryBytes(),
+                        recordUs, delay, hitsUs);
+        }
+    }
+    std::cout.rdbuf(coutBuffer);
+
+    std::printf("shot at a target's position 10.5 ticks ago: %s\n",
+                rewoundShotHits(10.5f) ? "rewound test hits, plain test misses" : "NOT COMPENSATED");
+}
+
+// ----------------------------------------------------------------------------
+// Spawns: baking the map's spawn points and handing them out
+// ----------------------------------------------------------------------------
+
+static void benchSpawn() {
+    const float sizes[][2] = {{800.0f, 600.0f}, {1600.0f, 1200.0f}};
+    const int rosters[] = {2, 8, 32, 100, 200, 400};
+
+    std::printf("spawn: Poisson-disk spawn points (spacing %d, denser tiers for large rosters), "
+                "min distance between spawned players\n", Map::SPAWN_SPACING);
+    std::printf("%10s %6s %8s %10s %8s %8s %12s %12s\n", "map", "tier", "points", "build ms", "valid", "players",
+                "min dist", "spawn us");
+
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+    for (const float* size : sizes) {
+        SimWorld world(size[0], size[1]);
+        const SpawnPlanner& planner = world.gameMap->spawnPoints;
+
+        // The shared map baked its points already; time a fresh bake of the same
+        SpawnPlanner rebuilt;
+        BenchClock::time_point start = BenchClock::now();
+        rebuilt.build(*world.gameMap, (float)Map::SPAWN_SPACING, (float)Map::SPAWN_RADIUS);
+        double buildMs = elapsedNs(start) / 1e6;
+
+        for (int roster : rosters) {
+            world.clearPlayers();
+            for (int p = 0; p < roster; p++) {
+                world.addPlayer(PlayerBody(p + 1, 0.0f, 0.0f));
+            }
+            start = BenchClock::now();
+            world.spawnPlayers();
+            double spawnUs = elapsedNs(start) / 1000.0;
+
+            // Every player on free floor, including ones offset off a point
+            bool valid = true;
+            for (const PlayerBody& body : world.entities.bodies) {
+                valid = valid && world.gameMap->isValidSpawnPositionFixed(body.fixedX, body.fixedY, planner.playerRadius);
+            }
+
+            float minDistance = 1e9f;
+            for (int a = 0; a < roster; a++) {
+                for (int b = a + 1; b < roster; b++) {
+                    const PlayerBody& pa = world.entities.bodies[a];
+                    const PlayerBody& pb = world.entities.bodies[b];
+                    minDistance = std::min(minDistance, std::sqrt((pa.x - pb.x) * (pa.x - pb.x) + (pa.y - pb.y) * (pa.y - pb.y)));
+                }
+            }
+
+            char mapName[32];
+            std::snprintf(mapName, sizeof(mapName), "%.0fx%.0f", size[0], size[1]);
+            int tier = planner.tierFor(roster);
+            std::printf("%10s %6d %8d %10.2f %8s %8d %12.1f %12.2f\n", mapName, tier, planner.tiers[tier].size(), buildMs,
+                        valid ? "yes" : "NO", roster, minDistance, spawnUs);
+        }
+    }
+    std::cout.rdbuf(coutBuffer);
+}
+
+// ----------------------------------------------------------------------------
+// Eliminations: alive set and event log against a full scan
+// ----------------------------------------------------------------------------
+
+static void benchEvents() {
+    const int players = 2048;
+    const int ticks = 600;
+
+    std::printf("events: %d players, %d ticks, alive count per tick\n", players, ticks);
+    std::printf("%12s %12s %10s %12s %8s\n", "scan ns", "counter ns", "alive", "eliminated", "agree");
+
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+    SimWorld world(4000.0f, 3000.0f);
+    placePlayers(world, players);
+    SnapshotRing ring(2, players, BulletPool::DEFAULT_CAPACITY);
+    std::vector<PlayerInput> inputs;
+    double scanNs = 0.0, counterNs = 0.0;
+    bool agree = true;
+    for (int t = 0; t < ticks && !world.matchOver; t++) {
+        scriptedInputs(world, inputs);
+        if (t == ticks / 2) {
+            // Roll back one tick partway through: the alive set and log must follow
+            ring.save(world);
+            world.step(inputs);
+            ring.restore(world, world.tick - 1);
+        }
+        world.step(inputs);
+
+        BenchClock::time_point start = BenchClock::now();
+        int scanned = 0;
+        for (const PlayerBody& body : world.entities.bodies) {
+            scanned += body.isAlive ? 1 : 0;
+        }
+        scanNs += elapsedNs(start);
+        start = BenchClock::now();
+        int counted = world.aliveCount();
+        counterNs += elapsedNs(start);
+
+        int kills = 0;
+        for (const Player& player : world.entities.players) {
+            kills += player.kills;
+        }
+        agree = agree && scanned == counted && (int)world.eliminations.size() == players - counted &&
+                kills == (int)world.eliminations.size();
+    }
+
+    // The id table has to follow swap-removes, and a restore that brings the
+    // removed players back
+    auto idsMatchScan = [&world, players]() {
+        for (int id = 0; id <= players + 1; id++) {
+            int scanned = -1;
+            for (int p = 0; p < world.entities.size(); p++) {
+                if (world.entities.bodies[p].id == id) scanned = p;
+            }
+            if (world.findPlayer(id) != scanned) return false;
+        }
+        return true;
+    };
+    WorldSnapshot beforeRemovals;
+    beforeRemovals.capture(world);
+    std::vector<EntityHandle> keep;
+    for (int p = 0; p < world.entities.size(); p += 3) {
+        keep.push_back(world.entities.denseHandle[p]);
+    }
+    world.retainPlayers(keep);
+    bool idsAgree = idsMatchScan();
+    beforeRemovals.restore(world);
+    idsAgree = idsAgree && idsMatchScan();
+    std::cout.rdbuf(coutBuffer);
+
+    std::printf("%12.1f %12.1f %10d %12u %8s\n", scanNs / ticks, counterNs / ticks, world.aliveCount(),
+                (unsigned int)world.eliminations.size(), agree ? "yes" : "NO");
+    std::printf("findPlayer after removals and a restore: %s\n", idsAgree ? "agrees with a scan" : "DIFFERS");
+}
+
+// ----------------------------------------------------------------------------
+// Walls: bullet wall hits cast once at spawn vs map queries every tick
+// ----------------------------------------------------------------------------
+
+// Tick on which a bullet flying straight from its spawn state first overlaps
+// a wall or leaves the map, sampling only tick end positions like the old
+// per-tick check did. -1 if it outlives its lifetime.
+static int sampledWallTick(const SimWorld& world, int i, int maxTicks) {
+    const BulletPool& bullets = world.bullets;
+    if (world.deterministic) {
+        Fixed x = bullets.fixedX[i], y = bullets.fixedY[i];
+        Fixed radius = toFixed(bullets.size);
+        for (int t = 1; t <= maxTicks; t++) {
+            x += fixedMul(bullets.fixedVX[i], world.fixedDt);
+            y += fixedMul(bullets.fixedVY[i], world.fixedDt);
+            if (world.gameMap->checkCollisionFixed(x, y, radius) || x < 0 || x > toFixed(world.width) ||
+                y < 0 || y > toFixed(world.height)) {
+                return t;
+            }
+        }
+    } else {
+        float x = bullets.x[i], y = bullets.y[i];
+        for (int t = 1; t <= maxTicks; t++) {
+            x += bullets.vx[i] * world.dt;
+            y += bullets.vy[i] * world.dt;
+            if (world.gameMap->checkCollision(x, y, bullets.size) || x < 0 || x > world.width || y < 0 ||
+                y > world.height) {
+                return t;
+            }
+        }
+    }
+    return -1;
+}
+
+static void benchWalls() {
+    const int bulletCount = 4000;
+    const int iterations = 200;
+
+    std::printf("walls: %d bullets fired across the default map, us per updateBullets() tick\n", bulletCount);
+    std::printf("%6s %12s %12s %8s %8s %8s\n", "mode", "per-tick", "cast", "same", "earlier", "later");
+
+    for (int mode = 0; mode < 2; mode++) {
+        SimWorld world(800.0f, 600.0f);
+        world.deterministic = mode == 1;
+        std::mt19937 rng(1971);
+        BenchClock::time_point start = BenchClock::now();
+        while (world.bullets.count < bulletCount) {
+            float x = 20.0f + (float)(rng() % 760);
+            float y = 20.0f + (float)(rng() % 560);
+            if (world.gameMap->checkCollisionFixed(toFixed(x), toFixed(y), 20 * FIXED_ONE)) continue;
+            PlayerBody body(1, x, y);
+            Player shooter;
+            shooter.setAim((int)(rng() % ANGLE_TURN));
+            world.spawnBullet(body, shooter);
+        }
+        double castUs = elapsedNs(start) / 1000.0;
+
+        // When each bullet's expiry says it hits a wall, against per-tick sampling
+        int maxTicks = (int)std::ceil(world.bullets.maxLifetime / world.dt);
+        std::vector<int> sampled(bulletCount);
+        for (int i = 0; i < bulletCount; i++) {
+            sampled[i] = sampledWallTick(world, i, maxTicks);
+        }
+        BulletPool spawned = world.bullets;
+        std::vector<int> died(bulletCount, -1);
+        for (int t = 1; t <= maxTicks; t++) {
+            world.updateBullets();
+            for (int i = 0; i < bulletCount; i++) {
+                if (died[i] < 0 && !world.bullets.active[i]) died[i] = t;
+            }
+        }
+        int same = 0, earlier = 0, later = 0;
+        for (int i = 0; i < bulletCount; i++) {
+            // Lifetime running out is not a wall hit. Earlier means the path
+            // clipped a corner between two sampled positions.
+            int cast = died[i] == maxTicks && sampled[i] < 0 ? -1 : died[i];
+            if (cast == sampled[i]) same++;
+            else if (sampled[i] < 0 || (cast >= 0 && cast < sampled[i])) earlier++;
+            else later++;
+        }
+
+        // Cost of a tick now, and with the per-tick map query it replaced
+        double castTickNs = 0.0, queryTickNs = 0.0;
+        std::vector<unsigned int> hits;
+        Fixed radius = toFixed(spawned.size);
+        for (int n = 0; n < iterations; n++) {
+            world.bullets = spawned;
+            start = BenchClock::now();
+            world.updateBullets();
+            castTickNs += elapsedNs(start);
+
+            world.bullets = spawned;
+            BulletPool& bullets = world.bullets;
+            start = BenchClock::now();
+            if (world.deterministic) {
+                bullets.updateFixedRange(0, bullets.count, world.fixedDt);
+                for (int i = 0; i < bullets.count; i++) {
+                    if (world.gameMap->checkCollisionFixed(bullets.fixedX[i], bullets.fixedY[i], radius)) {
+                        bullets.kill(i);
+                    }
+                }
+            } else {
+                bullets.updateRange(0, bullets.count, world.dt);
+                world.gameMap->checkCollisionBatch(bullets.x.data(), bullets.y.data(), bullets.count,
+                                                   bullets.size, hits);
+                for (int i = bullets.count - 1; i >= 0; i--) {
+                    if (hits[i / 32] & (1u << (i % 32))) bullets.kill(i);
+                }
+            }
+            queryTickNs += elapsedNs(start);
+        }
+
+        std::printf("%6s %12.1f %12.1f %8d %8d %8d\n", world.deterministic ? "fixed" : "float",
+                    queryTickNs / 1000.0 / iterations, castTickNs / 1000.0 / iterations, same, earlier, later);
+        std::printf("%6s one-off cast cost at spawn: %.2f us per bullet\n", "", castUs / bulletCount);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Players: hot/cold split vs the single Player record it replaced
+// ----------------------------------------------------------------------------
+
+// Player as it was laid out before PlayerBody was split off
+struct LegacyPlayer {
+    int id;
+    float x, y;
+    float prevX, prevY;
+    float speed;
+    float size;
+    float angle;
+    bool isAlive;
+    int kills;
+    Fixed fixedX, fixedY;
+    int fixedAngle;
+};
+
+// Hardware cache-miss counter for the calling thread. Where the kernel or a
+// VM doesn't expose one, ok is false and the bench reports n/a.
+struct MissCounter {
+    int fd;
+    bool ok;
+
+    MissCounter() : fd(-1), ok(false) {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        ok = fd >= 0;
+#endif
+    }
+    ~MissCounter() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+    void start() {
+#ifdef __linux__
+        if (!ok) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+    long long stop() {
+        long long misses = 0;
+#ifdef __linux__
+        if (!ok) return 0;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &misses, sizeof(misses)) != sizeof(misses)) misses = 0;
+#endif
+        return misses;
+    }
+};
+
+// The per-tick player passes of SimWorld::step(): grid build, movement and
+// the hit tests' candidate lookups. Works on either layout.
+template <typename T>
+static int playerPasses(std::vector<T>& players, const std::vector<int>& candidates) {
+    int live = 0;
+    for (const T& player : players) {
+        if (player.isAlive) live += (int)player.x ^ (int)player.y;
+    }
+    for (T& player : players) {
+        if (!player.isAlive) continue;
+        player.x += player.speed * benchDt;
+        player.fixedX = toFixed(player.x);
+        if (player.x > 4000.0f) player.x -= 4000.0f;
+    }
+    int hits = 0;
+    for (int p : candidates) {
+        const T& player = players[p];
+        if (!player.isAlive || player.id == 0) continue;
+        float dx = player.x - 2000.0f;
+        float dy = player.y - 1500.0f;
+        hits += dx * dx + dy * dy < player.size * player.size;
+    }
+    return live + hits;
+}
+
+static void benchPlayers() {
+    const int playerCounts[] = {100, 1000};
+    const int ticks = 200;
+    const int candidatesPerTick = 8000;     // Grid candidates of ~2,000 bullets
+
+    MissCounter counter;
+    std::printf("players: per-tick player passes from a cold cache, Player %u bytes before, "
+                "PlayerBody %u bytes now\n", (unsigned int)sizeof(LegacyPlayer), (unsigned int)sizeof(PlayerBody));
+    std::printf("%8s %10s %12s %12s %12s\n", "players", "layout", "lines", "misses", "us/tick");
+
+    // Evicting this between ticks makes every tick start from memory, as it
+    // does in the game where bullets and the map run in between
+    std::vector<unsigned char> evict(32 << 20, 1);
+    for (int players : playerCounts) {
+        std::mt19937 rng(1971);
+        std::vector<LegacyPlayer> legacy(players);
+        std::vector<PlayerBody> bodies(players);
+        for (int p = 0; p < players; p++) {
+            bodies[p] = PlayerBody(p + 1, (float)(rng() % 4000), (float)(rng() % 3000));
+            LegacyPlayer& old = legacy[p];
+            std::memset(&old, 0, sizeof(old));
+            old.id = p + 1;
+            old.x = bodies[p].x;
+            old.y = bodies[p].y;
+            old.speed = bodies[p].speed;
+            old.size = bodies[p].size;
+            old.isAlive = true;
+        }
+        std::vector<int> candidates(candidatesPerTick);
+        for (int& c : candidates) {
+            c = (int)(rng() % players);
+        }
+
+        for (int layout = 0; layout < 2; layout++) {
+            double ns = 0.0;
+            long long misses = 0;
+            for (int t = 0; t < ticks; t++) {
+                for (size_t i = 0; i < evict.size(); i += 64) {
+                    evict[i]++;
+                }
+                counter.start();
+                BenchClock::time_point start = BenchClock::now();
+                int result = layout == 0 ? playerPasses(legacy, candidates) : playerPasses(bodies, candidates);
+                ns += elapsedNs(start);
+                misses += counter.stop();
+                benchSink = benchSink + (float)result;
+            }
+            size_t bytes = (size_t)players * (layout == 0 ? sizeof(LegacyPlayer) : sizeof(PlayerBody));
+            char missText[32];
+            if (counter.ok) {
+                std::snprintf(missText, sizeof(missText), "%lld", misses / ticks);
+            } else {
+                std::snprintf(missText, sizeof(missText), "n/a");
+            }
+            std::printf("%8d %10s %12u %12s %12.1f\n", players, layout == 0 ? "Player" : "PlayerBody",
+                        (unsigned int)((bytes + 63) / 64), missText, ns / 1000.0 / ticks);
+        }
+    }
+    benchSink = benchSink + (float)evict[0];
+}
+
+// ----------------------------------------------------------------------------
+// Trig: FastMath polynomials vs libm
+// ----------------------------------------------------------------------------
+
+static void benchTrig() {
+    const int count = 1 << 20;
+    const int repeats = 20;
+
+    std::mt19937 rng(1971);
+    std::uniform_real_distribution<float> angles(-4.0f * FAST_PI, 4.0f * FAST_PI);
+    std::uniform_real_distribution<float> coords(-1000.0f, 1000.0f);
+    std::vector<float> a(count), x(count), y(count), outS(count), outC(count);
+    for (int i = 0; i < count; i++) {
+        a[i] = angles(rng);
+        x[i] = coords(rng);
+        y[i] = coords(rng);
+    }
+
+    std::printf("trig: ns/value over %d values, max error against double-precision libm\n", count);
+    std::printf("%22s %10s %10s %10s %12s %8s\n", "function", "libm", "fast", "array", "max error", "array");
+
+    // sin and cos together, as setAim needs them
+    BenchClock::time_point start = BenchClock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (int i = 0; i < count; i++) {
+            outS[i] = std::sin(a[i]);
+            outC[i] = std::cos(a[i]);
+        }
+        benchSink = benchSink + outS[r] + outC[r];
+    }
+    double libmNs = elapsedNs(start) / ((double)count * repeats);
+    start = BenchClock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (int i = 0; i < count; i++) {
+            fastSinCos(a[i], outS[i], outC[i]);
+        }
+        benchSink = benchSink + outS[r] + outC[r];
+    }
+    double fastNs = elapsedNs(start) / ((double)count * repeats);
+    double error = 0.0;
+    for (int i = 0; i < count; i++) {
+        error = std::max(error, std::fabs(outS[i] - std::sin((double)a[i])));
+        error = std::max(error, std::fabs(outC[i] - std::cos((double)a[i])));
+    }
+    std::vector<float> arrayS(count), arrayC(count);
+    start = BenchClock::now();
+    for (int r = 0; r < repeats; r++) {
+        fastSinCosArray(a.data(), count, arrayS.data(), arrayC.data());
+        benchSink = benchSink + arrayS[r] + arrayC[r];
+    }
+    double arrayNs = elapsedNs(start) / ((double)count * repeats);
+    bool same = arrayS == outS && arrayC == outC;
+    std::printf("%22s %10.2f %10.2f %10.2f %12.2g %8s\n", "sin + cos", libmNs, fastNs, arrayNs, error,
+                same ? "same" : "DIFFER");
+
+    start = BenchClock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (int i = 0; i < count; i++) {
+            outS[i] = std::atan2(y[i], x[i]);
+        }
+        benchSink = benchSink + outS[r];
+    }
+    libmNs = elapsedNs(start) / ((double)count * repeats);
+    start = BenchClock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (int i = 0; i < count; i++) {
+            outS[i] = fastAtan2(y[i], x[i]);
+        }
+        benchSink = benchSink + outS[r];
+    }
+    fastNs = elapsedNs(start) / ((double)count * repeats);
+    error = 0.0;
+    for (int i = 0; i < count; i++) {
+        error = std::max(error, std::fabs(outS[i] - std::atan2((double)y[i], (double)x[i])));
+    }
+    start = BenchClock::now();
+    for (int r = 0; r < repeats; r++) {
+        fastAtan2Array(y.data(), x.data(), count, arrayS.data());
+        benchSink = benchSink + arrayS[r];
+    }
+    arrayNs = elapsedNs(start) / ((double)count * repeats);
+    same = arrayS == outS;
+    std::printf("%22s %10.2f %10.2f %10.2f %12.2g %8s\n", "atan2", libmNs, fastNs, arrayNs, error,
+                same ? "same" : "DIFFER");
+
+    // What drawing a bullet used to cost (atan2, then degrees for glRotatef)
+    // against normalizing its velocity into the rotation matrix columns
+    start = BenchClock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (int i = 0; i < count; i++) {
+            outS[i] = std::atan2(y[i], x[i]) * 180.0f / 3.14159f;
+        }
+        benchSink = benchSink + outS[r];
+    }
+    libmNs = elapsedNs(start) / ((double)count * repeats);
+    start = BenchClock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (int i = 0; i < count; i++) {
+            float inverse = 1.0f / std::sqrt(x[i] * x[i] + y[i] * y[i]);
+            outS[i] = x[i] * inverse;
+            outC[i] = y[i] * inverse;
+        }
+        benchSink = benchSink + outS[r] + outC[r];
+    }
+    fastNs = elapsedNs(start) / ((double)count * repeats);
+    std::printf("%22s %10.2f %10.2f %10s %12s\n", "bullet draw rotation", libmNs, fastNs, "", "exact");
+}
+
+// ----------------------------------------------------------------------------
+// Random: counter-based streams vs a shared generator behind a mutex
+// ----------------------------------------------------------------------------
+
+// Published Philox4x32-10 test vectors (Random123 kat_vectors)
+static bool philoxMatchesReference() {
+    const unsigned int counters[2][4] = {{0, 0, 0, 0}, {0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}};
+    const unsigned int keys[2][2] = {{0, 0}, {0xa4093822u, 0x299f31d0u}};
+    const unsigned int expected[2][4] = {{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u},
+                                         {0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}};
+    for (int v = 0; v < 2; v++) {
+        unsigned int out[4];
+        RandomStream::block(counters[v], keys[v], out);
+        if (std::memcmp(out, expected[v], sizeof(out)) != 0) return false;
+    }
+    return true;
+}
+
+static void benchRandom() {
+    const int threadCounts[] = {1, 4, 16};
+    const int entities = 100000;
+    const int draws = 16;
+    const unsigned int seed = 1971;
+    const unsigned int tick = 42;
+
+    std::printf("random: %d entities x %d draws per tick, hash of every entity's numbers\n", entities, draws);
+    std::printf("%8s %14s %20s %14s %20s\n", "threads", "philox ns", "philox hash", "mutex ns", "mutex hash");
+
+    std::vector<unsigned int> results((size_t)entities * draws);
+    unsigned long long reference = 0;
+    bool stable = true;
+    for (int threads : threadCounts) {
+        JobSystem jobs(threads);
+
+        BenchClock::time_point start = BenchClock::now();
+        jobs.parallelFor(entities, 256, [&](int begin, int end) {
+            for (int e = begin; e < end; e++) {
+                RandomStream random(seed, RANDOM_SPAWN, (unsigned int)e, tick);
+                for (int d = 0; d < draws; d++) {
+                    results[(size_t)e * draws + d] = random.next();
+                }
+            }
+        });
+        double philoxNs = elapsedNs(start) / ((double)entities * draws);
+        unsigned long long philoxHash = 14695981039346656037ull;
+        for (unsigned int value : results) {
+            philoxHash = (philoxHash ^ value) * 1099511628211ull;
+        }
+
+        // What the streams replace: one engine, locked per entity
+        std::mt19937 shared(seed);
+        std::mutex sharedLock;
+        start = BenchClock::now();
+        jobs.parallelFor(entities, 256, [&](int begin, int end) {
+            for (int e = begin; e < end; e++) {
+                std::lock_guard<std::mutex> guard(sharedLock);
+                for (int d = 0; d < draws; d++) {
+                    results[(size_t)e * draws + d] = shared();
+                }
+            }
+        });
+        double mutexNs = elapsedNs(start) / ((double)entities * draws);
+        unsigned long long mutexHash = 14695981039346656037ull;
+        for (unsigned int value : results) {
+            mutexHash = (mutexHash ^ value) * 1099511628211ull;
+        }
+
+        if (threads == threadCounts[0]) reference = philoxHash;
+        stable = stable && philoxHash == reference;
+        std::printf("%8d %14.2f %20llx %14.2f %20llx\n", threads, philoxNs, philoxHash, mutexNs, mutexHash);
+    }
+
+    std::printf("philox reference vectors: %s, streams %s across thread counts\n",
+                philoxMatchesReference() ? "match" : "DIFFER", stable ? "identical" : "DIFFER");
+}
+
+// ----------------------------------------------------------------------------
+// Separation: pushing overlapping players apart in a crowded final circle
+// ----------------------------------------------------------------------------
+
+// Players scattered over a disc with four times their own area each, so
+// most overlap a neighbour
+static void crowdPlayers(SimWorld& world, int players) {
+    std::mt19937 rng(1971);
+    float radius = 20.0f * std::sqrt((float)players);
+    float centerX = world.width / 2.0f;
+    float centerY = world.height / 2.0f;
+    for (int p = 0; p < players; p++) {
+        float x, y;
+        do {
+            float angle = (float)(rng() % 3600) * 0.1f * 0.0174533f;
+            float distance = radius * std::sqrt((float)(rng() % 10000) / 10000.0f);
+            x = centerX + std::cos(angle) * distance;
+            y = centerY + std::sin(angle) * distance;
+        } while (world.gameMap->checkCollisionFixed(toFixed(x), toFixed(y), 10 * FIXED_ONE));
+        world.addPlayer(PlayerBody(p + 1, x, y));
+    }
+}
+
+// Overlapping pairs and the deepest overlap, by brute force
+static int countOverlaps(const std::vector<PlayerBody>& bodies, float& deepest) {
+    int pairs = 0;
+    deepest = 0.0f;
+    for (size_t p = 0; p < bodies.size(); p++) {
+        for (size_t q = p + 1; q < bodies.size(); q++) {
+            float dx = bodies[p].x - bodies[q].x;
+            float dy = bodies[p].y - bodies[q].y;
+            float overlap = (bodies[p].size + bodies[q].size) / 2.0f - std::sqrt(dx * dx + dy * dy);
+            if (overlap > 0.0f) {
+                pairs++;
+                deepest = std::max(deepest, overlap);
+            }
+        }
+    }
+    return pairs;
+}
+
+// What the grid avoids: every pair tested, then the same capped pushes
+static void separatePairwise(std::vector<PlayerBody>& bodies, const Map* map, std::vector<float>& pushes) {
+    int count = (int)bodies.size();
+    pushes.assign((size_t)count * 2, 0.0f);
+    for (int p = 0; p < count; p++) {
+        for (int q = p + 1; q < count; q++) {
+            float dx = bodies[p].x - bodies[q].x;
+            float dy = bodies[p].y - bodies[q].y;
+            float contact = (bodies[p].size + bodies[q].size) / 2.0f;
+            float distanceSquared = dx * dx + dy * dy;
+            if (distanceSquared >= contact * contact) continue;
+            float distance = std::sqrt(distanceSquared);
+            float half = (contact - distance) / 2.0f;
+            float nx = distance > 0.0f ? dx / distance : -1.0f;
+            float ny = distance > 0.0f ? dy / distance : 0.0f;
+            pushes[p * 2] += nx * half;
+            pushes[p * 2 + 1] += ny * half;
+            pushes[q * 2] -= nx * half;
+            pushes[q * 2 + 1] -= ny * half;
+        }
+    }
+    for (int p = 0; p < count; p++) {
+        float pushX = pushes[p * 2];
+        float pushY = pushes[p * 2 + 1];
+        float maxPush = bodies[p].size / 2.0f;
+        float lengthSquared = pushX * pushX + pushY * pushY;
+        if (lengthSquared == 0.0f) continue;
+        if (lengthSquared > maxPush * maxPush) {
+            float scale = maxPush / std::sqrt(lengthSquared);
+            pushX *= scale;
+            pushY *= scale;
+        }
+        map->moveCircle(bodies[p].x, bodies[p].y, bodies[p].size / 2.0f, pushX, pushY);
+    }
+}
+
+static void benchSeparation() {
+    const int playerCounts[] = {50, 100, 200, 500};
+    const int iterations = 2000;
+
+    std::printf("separation: one push-apart pass over players crowded into a final circle\n");
+    std::printf("%8s %10s %10s %10s %10s %12s %12s %8s\n", "players", "overlaps", "deepest", "after",
+                "deepest", "grid us", "pairwise us", "same");
+
+    bool stable = true;
+    for (int players : playerCounts) {
+        SimWorld world(1600.0f, 1200.0f);
+        crowdPlayers(world, players);
+        const std::vector<PlayerBody> start = world.entities.bodies;
+
+        float deepestBefore, deepestAfter;
+        int overlapsBefore = countOverlaps(start, deepestBefore);
+
+        // The grid build is counted: the hit tests reuse it, but separation
+        // is what now forces it to happen before them
+        double gridNs = 0.0;
+        for (int n = 0; n < iterations; n++) {
+            world.entities.bodies = start;
+            BenchClock::time_point begin = BenchClock::now();
+            world.buildPlayerGrid();
+            world.separatePlayers();
+            gridNs += elapsedNs(begin);
+        }
+        int overlapsAfter = countOverlaps(world.entities.bodies, deepestAfter);
+
+        std::vector<PlayerBody> pairwise;
+        std::vector<float> pushes;
+        double pairwiseNs = 0.0;
+        for (int n = 0; n < iterations; n++) {
+            pairwise = start;
+            BenchClock::time_point begin = BenchClock::now();
+            separatePairwise(pairwise, world.gameMap, pushes);
+            pairwiseNs += elapsedNs(begin);
+        }
+        bool same = true;
+        for (int p = 0; p < players; p++) {
+            same = same && std::fabs(pairwise[p].x - world.entities.bodies[p].x) < 0.01f &&
+                   std::fabs(pairwise[p].y - world.entities.bodies[p].y) < 0.01f;
+        }
+
+        // Deterministic mode must not depend on the thread count
+        const int threadCounts[] = {0, 4};  // 0 = serial, no job system
+        unsigned long long reference = 0;
+        for (int threads : threadCounts) {
+            JobSystem jobs(std::max(threads, 1));
+            world.jobs = threads > 0 ? &jobs : nullptr;
+            world.entities.bodies = start;
+            world.setDeterministic(true);
+            world.buildPlayerGrid();
+            world.separatePlayers();
+            if (threads == 0) reference = world.stateHash();
+            stable = stable && world.stateHash() == reference;
+            world.jobs = nullptr;
+        }
+
+        std::printf("%8d %10d %10.2f %10d %10.2f %12.2f %12.2f %8s\n", players, overlapsBefore, deepestBefore,
+                    overlapsAfter, deepestAfter, gridNs / 1000.0 / iterations, pairwiseNs / 1000.0 / iterations,
+                    same ? "yes" : "NO");
+    }
+    std::printf("deterministic: %s with and without worker threads\n", stable ? "identical" : "DIFFER");
+}
+
+struct BenchEntry {
+    const char* name;
+    void (*run)();
+};
+
+static const BenchEntry benchmarks[] = {
+    {"bullets", benchBullets},
+    {"integrate", benchIntegrate},
+    {"hits", benchHits},
+    {"map", benchMap},
+    {"threads", benchThreads},
+    {"matches", benchMatches},
+    {"lockstep", benchLockstep},
+    {"replay", benchReplay},
+    {"snapshot", benchSnapshot},
+    {"rollback", benchRollback},
+    {"lagcomp", benchLagComp},
+    {"spawn", benchSpawn},
+    {"events", benchEvents},
+    {"walls", benchWalls},
+    {"players", benchPlayers},
+    {"trig", benchTrig},
+    {"random", benchRandom},
+    {"separation", benchSeparation},
+};
+
+int main(int argc, char** argv) {
+    const char* only = (argc > 1) ? argv[1] : nullptr;
+    for (const BenchEntry& entry : benchmarks) {
+        if (only == nullptr || std::strcmp(only, entry.name) == 0) {
+            entry.run();
+            std::printf("\n");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+#!/usr/bin/env python3
+"""
+Build and run the headless simulation benchmarks.
+Run from project root: python build/bench.py [benchmark name]
+"""
+import os, sys, glob, platform, subprocess
+
+def run(cmd):
+    print(">", " ".join(cmd))
+    return subprocess.call(cmd)
+
+# Get project root directory (parent of build/)
+project_root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+os.chdir(project_root)
+
+# Simulation sources only: skip the GLUT front-end, its entry point and networking
+frontend = {"Game.cpp", "Sound.cpp", "main.cpp", "PeerLink.cpp"}
+src_dir = os.path.join(project_root, "src")
+cpps = sorted(f for f in glob.glob(os.path.join(src_dir, "*.cpp"))
+              if os.path.basename(f) not in frontend)
+cpps.append(os.path.join(project_root, "bench", "SimBench.cpp"))
+
+system = platform.system()
+exe_name = "simbench.exe" if system == "Windows" else "simbench"
+
+bin_dir = os.path.join(project_root, "bin", "Release")
+os.makedirs(bin_dir, exist_ok=True)
+exe_path = os.path.join(bin_dir, exe_name)
+
+include_dir = os.path.join(project_root, "include")
+cmd = ["g++", "-std=c++11", "-O2", "-DOJ_HEADLESS", "-I" + include_dir, *cpps, "-o", exe_path]
+if system != "Windows":
+    cmd.append("-pthread")  # JobSystem worker threads
+
+print("Building benchmarks...")
+rc = run(cmd)
+if rc != 0:
+    sys.exit(rc)
+
+sys.exit(run([exe_path, *sys.argv[1:]]))
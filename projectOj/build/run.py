@@ -28,19 +28,36 @@ bin_dir = os.path.join(project_root, "bin", "Debug")
 os.makedirs(bin_dir, exist_ok=True)
 exe_path = os.path.join(bin_dir, exe_name)
 
-# Base compile command with include directory
+# ENet (LAN matches): the prebuilt library on Windows, built from the
+# bundled sources elsewhere
+enet_dir = os.path.join(project_root, "enet")
+enet_libs = []
+if system == "Windows":
+    enet_libs = [os.path.join(enet_dir, "enet64.lib")]
+else:
+    obj_dir = os.path.join(bin_dir, "enet")
+    os.makedirs(obj_dir, exist_ok=True)
+    for name in ["callbacks", "compress", "host", "list", "packet", "peer", "protocol", "unix"]:
+        obj = os.path.join(obj_dir, name + ".o")
+        rc = run(["gcc", "-O2", "-I" + os.path.join(enet_dir, "include"),
+                  "-c", os.path.join(enet_dir, name + ".c"), "-o", obj])
+        if rc != 0:
+            sys.exit(rc)
+        enet_libs.append(obj)
+
+# Base compile command with include directories
 include_dir = os.path.join(project_root, "include")
-cmd = ["g++", "-I" + include_dir, *cpps, "-o", exe_path]
+cmd = ["g++", "-I" + include_dir, "-I" + os.path.join(enet_dir, "include"), *cpps, *enet_libs, "-o", exe_path]
 
 # OS-specific link flags
 if system == "Windows":
-    cmd += ["-lfreeglut", "-lopengl32", "-lglu32", "-lgdi32", "-lwinmm"]
+    cmd += ["-lfreeglut", "-lopengl32", "-lglu32", "-lgdi32", "-lwinmm", "-lws2_32"]
 elif system == "Darwin":  # macOS
     # Try freeglut first (Homebrew), then fallback to system GLUT
     # You can swap -lfreeglut -> -lglut if you prefer system GLUT
     cmd += ["-framework", "OpenGL", "-lfreeglut"]
 else:  # Linux
-    cmd += ["-lfreeglut", "-lGL", "-lGLU"]
+    cmd += ["-lfreeglut", "-lGL", "-lGLU", "-pthread"]
 
 # Build
 print(f"Building from {src_dir}...")
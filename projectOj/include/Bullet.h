@@ -1,11 +1,10 @@
 #pragma once
-#include <GL/freeglut.h>
 
 class Bullet {
 public:
     float x, y;           // Position
-    float vx, vy;         // Velocity
-    float speed;          // Bullet speed
+    float vx, vy;         // Velocity (units per second)
+    float speed;          // Bullet speed (units per second)
     float size;           // Bullet size
     bool active;          // Whether bullet is still active
     int ownerId;          // ID of player who shot this bullet
@@ -13,10 +12,13 @@ public:
     float maxLifetime;    // Maximum lifetime before bullet despawns
 
     Bullet();
-    Bullet(float startX, float startY, float angle, int ownerId, float bulletSpeed = 10.0f);
+    Bullet(float startX, float startY, float dirX, float dirY, int ownerId, float bulletSpeed = 600.0f);  // (dirX, dirY) is a unit vector
     
-    void update();
+    void update(float dt);
+#ifndef OJ_HEADLESS
     void render();
+    static void draw(float x, float y, float vx, float vy, float size);
+#endif
     bool isOutOfBounds(int screenWidth, int screenHeight);
 };
 
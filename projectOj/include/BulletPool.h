@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include "FixedPoint.h"
+
+// Fixed-capacity bullet storage laid out as parallel arrays (structure of
+// arrays). Live bullets are always packed into [0, count); dead ones are
+// removed by swapping the last live bullet into their slot, so nothing is
+// allocated after construction.
+class BulletPool {
+public:
+    static const int DEFAULT_CAPACITY = 4096;
+
+    int capacity;
+    int count;                          // Number of bullets in [0, count)
+    float size;                         // Collision radius shared by all bullets
+    float maxLifetime;                  // Seconds before a bullet despawns
+
+    std::vector<float> x, y;            // Position
+    std::vector<float> prevX, prevY;    // Position before the last update (render interpolation)
+    std::vector<float> vx, vy;          // Velocity (units per second)
+    std::vector<float> lifetime;        // Time bullet has been alive
+    std::vector<float> expiry;          // Lifetime at which it dies: maxLifetime, or earlier if its path hits a wall
+    std::vector<int> owner;             // ID of player who shot this bullet
+    std::vector<unsigned char> active;  // Cleared when the bullet hits or expires
+    std::vector<unsigned int> deadMask; // Bit per slot, set by kill() and expiry, consumed by compact()
+
+    // Deterministic mode: authoritative fixed-point state; x, y, vx, vy and
+    // lifetime are derived from it for rendering
+    std::vector<Fixed> fixedX, fixedY;
+    std::vector<Fixed> fixedVX, fixedVY;
+    std::vector<Fixed> fixedLifetime;
+    std::vector<Fixed> fixedExpiry;
+
+    // Lag compensation: how many ticks (fractional) the owner's view trailed
+    // the simulation when firing; hits are tested against targets rewound by
+    // this much. Zero for local players.
+    std::vector<Fixed> rewind;
+
+    explicit BulletPool(int capacity = DEFAULT_CAPACITY);
+
+    // Fire along the unit vector (dirX, dirY). Returns the new bullet's
+    // index, or -1 if the pool is full
+    int spawn(float startX, float startY, float dirX, float dirY, int ownerId, float bulletSpeed = 600.0f);
+    // Advance positions and lifetimes of all bullets (SIMD), killing those
+    // that reach their expiry
+    void update(float dt);
+    // update() for bullets [begin, end) only. begin must be a multiple of 32 so
+    // ranges running on different threads never share a deadMask word.
+    void updateRange(int begin, int end, float dt);
+    void updateScalar(float dt);  // Reference version of update() without SIMD
+    // Fixed-point spawn/update for deterministic mode. angle is a binary angle
+    // of the flight direction.
+    int spawnFixed(Fixed startX, Fixed startY, int angle, int ownerId, Fixed bulletSpeed);
+    void updateFixedRange(int begin, int end, Fixed dt);  // Same range rules as updateRange()
+    void kill(int i);
+    void compact();             // Swap-remove every dead bullet
+    void clear();
+
+private:
+    void expire(unsigned int lanes, int first);  // Kill the bullets flagged in lanes
+};
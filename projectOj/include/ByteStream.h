@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+#include <cstring>
+#include <cstddef>
+
+// Little-endian writers/readers for replay files and network packets, so the
+// bytes mean the same on every machine
+inline void putU16(std::vector<unsigned char>& out, unsigned short value) {
+    out.push_back((unsigned char)value);
+    out.push_back((unsigned char)(value >> 8));
+}
+
+inline void putU32(std::vector<unsigned char>& out, unsigned int value) {
+    for (int i = 0; i < 4; i++) {
+        out.push_back((unsigned char)(value >> (8 * i)));
+    }
+}
+
+inline void putU64(std::vector<unsigned char>& out, unsigned long long value) {
+    putU32(out, (unsigned int)value);
+    putU32(out, (unsigned int)(value >> 32));
+}
+
+inline void putFloat(std::vector<unsigned char>& out, float value) {
+    unsigned int bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putU32(out, bits);
+}
+
+// 7 bits per byte, high bit set on all but the last
+inline void putVarint(std::vector<unsigned char>& out, unsigned int value) {
+    while (value >= 0x80) {
+        out.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((unsigned char)value);
+}
+
+// Reads values in order; ok turns false on overrun and reads return 0 from then on
+struct ByteReader {
+    const unsigned char* bytes;
+    size_t size;
+    size_t offset;
+    bool ok;
+
+    ByteReader(const unsigned char* bytes, size_t size, size_t offset = 0)
+        : bytes(bytes), size(size), offset(offset), ok(true) {}
+
+    unsigned char u8() {
+        if (offset >= size) {
+            ok = false;
+            return 0;
+        }
+        return bytes[offset++];
+    }
+
+    unsigned short u16() {
+        unsigned short low = u8();
+        return (unsigned short)(low | (u8() << 8));
+    }
+
+    unsigned int u32() {
+        unsigned int value = 0;
+        for (int i = 0; i < 4; i++) {
+            value |= (unsigned int)u8() << (8 * i);
+        }
+        return value;
+    }
+
+    unsigned long long u64() {
+        unsigned long long low = u32();
+        return low | ((unsigned long long)u32() << 32);
+    }
+
+    float f32() {
+        unsigned int bits = u32();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    unsigned int varint() {
+        unsigned int value = 0;
+        for (int shift = 0; shift < 35 && ok; shift += 7) {
+            unsigned char byte = u8();
+            value |= (unsigned int)(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) break;
+        }
+        return value;
+    }
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include "FixedPoint.h"
+
+class Obstacle;
+class Rect;
+class RectBVH;
+
+// Signed distance to the nearest obstacle, sampled on a regular grid.
+// Baked once when the map loads; afterwards a query is one bilinear lookup no
+// matter how many obstacles there are or how they are rotated. Distances are
+// negative inside an obstacle.
+class DistanceField {
+public:
+    float originX, originY;         // World position of sample (0, 0)
+    float cellSize;                 // Spacing between samples
+    int columns, rows;              // Number of samples along x and y
+    std::vector<float> values;      // Sample (c, r) is values[r * columns + c]
+    std::vector<Fixed> fixedValues; // Same samples computed in fixed point, for deterministic mode
+    Fixed fixedOriginX, fixedOriginY;
+    Fixed fixedCellSize;
+
+    DistanceField();
+
+    static const int BLOCK = 8;     // Samples per side of the blocks build() culls obstacles for
+
+    // Sample the obstacles over the box [minX, maxX] x [minY, maxY]. bounds
+    // and tree are the obstacles' boxes and the BVH over them (Map's
+    // collisionRects and collisionTree), used to skip far obstacles.
+    void build(const std::vector<Obstacle>& obstacles, const std::vector<Rect>& bounds, const RectBVH& tree,
+               float minX, float minY, float maxX, float maxY, float cellSize);
+    void clear();
+
+    bool covers(float x, float y) const;    // Inside the sampled box
+
+    // Bilinear distance at (x, y); points outside the box are clamped to its edge
+    float sample(float x, float y) const;
+
+    // sample() for count points at once into out, several per SIMD lane
+    // group. Bit-identical to calling sample() on each point.
+    void sampleBatch(const float* xs, const float* ys, int count, float* out) const;
+
+    // Direction of increasing distance (away from the nearest surface), not
+    // normalized. Zero where the field is flat.
+    void gradient(float x, float y, float& outX, float& outY) const;
+
+    // Fixed-point versions of the queries above, built only from fixedValues
+    bool coversFixed(Fixed x, Fixed y) const;
+    Fixed sampleFixed(Fixed x, Fixed y) const;
+    void gradientFixed(Fixed x, Fixed y, Fixed& outX, Fixed& outY) const;
+
+private:
+    // Cell containing (x, y) and the position inside it (0..1 on each axis)
+    void locate(float x, float y, int& c, int& r, float& fx, float& fy) const;
+    void locateFixed(Fixed x, Fixed y, int& c, int& r, Fixed& fx, Fixed& fy) const;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include "Player.h"
+
+// 32-bit generational handle: low 20 bits are the slot, high 12 bits the
+// slot's generation when the handle was issued. Destroying an entity bumps the
+// generation, so old handles stop resolving instead of dangling.
+typedef unsigned int EntityHandle;
+
+const EntityHandle INVALID_ENTITY = 0;  // Generation 0 is never issued
+
+// Player archetype storage. Components live in dense arrays indexed by
+// [0, size()), which the simulation iterates directly; everything outside the
+// simulation (rooms, matches, the local front-end) holds handles instead.
+// Dense indices and component pointers are only stable until the next create
+// or destroy.
+class EntityStore {
+public:
+    static const int SLOT_BITS = 20;
+    static const unsigned int SLOT_MASK = (1u << SLOT_BITS) - 1;
+    static const unsigned int GENERATION_MASK = (1u << (32 - SLOT_BITS)) - 1;
+
+    // Dense component arrays
+    std::vector<PlayerBody> bodies;             // Per-tick state (hot)
+    std::vector<Player> players;                // Aim, stats and render state (cold)
+    std::vector<EntityHandle> denseHandle;      // Handle of each dense entry
+
+    // Sparse slot table
+    std::vector<int> slotDense;                 // Dense index of each slot, -1 when free
+    std::vector<unsigned int> slotGeneration;
+    std::vector<unsigned int> freeSlots;
+
+    // Dense index of each player id (PlayerBody::id, unique within a store),
+    // -1 when none. Kept up to date by create() and destroy().
+    std::vector<int> idDense;
+
+    EntityHandle create(const PlayerBody& body, const Player& player = Player());
+    bool destroy(EntityHandle handle);
+    bool isValid(EntityHandle handle) const;
+    Player* get(EntityHandle handle);
+    const Player* get(EntityHandle handle) const;
+    PlayerBody* body(EntityHandle handle);
+    const PlayerBody* body(EntityHandle handle) const;
+    int indexOf(EntityHandle handle) const;     // Dense index, -1 if stale
+    int indexOfId(int id) const;                // Dense index of the player with this id, -1 if none
+    void rebuildIdIndex();                      // After replacing the dense arrays wholesale
+    int size() const;
+    void clear();
+
+    static unsigned int slotOf(EntityHandle handle);
+    static unsigned int generationOf(EntityHandle handle);
+};
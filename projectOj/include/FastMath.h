@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cmath>
+
+// Polynomial sine/cosine and atan2 for float mode and display code, within
+// 1e-7 (sin, cos) and 2e-6 rad (atan2) of libm. Only multiplies, adds and
+// selects; the Array versions at the bottom run the same steps four values
+// at a time in SSE2 lanes.
+// Deterministic mode doesn't use these; it keeps binary angles and the
+// integer tables in FixedPoint.h.
+
+const float FAST_PI = 3.14159265f;
+const float FAST_HALF_PI = 1.57079633f;
+
+// Sine and cosine of an angle in radians
+inline void fastSinCos(float radians, float& outSin, float& outCos) {
+    // radians = k * pi/2 + r with |r| <= pi/4; pi/2 is split in two so the
+    // reduction stays exact for large angles. Rounds by truncating, since
+    // floor is a library call without SSE4.1
+    float scaled = radians * 0.636619772f;
+    int k = (int)(scaled + (scaled < 0.0f ? -0.5f : 0.5f));
+    float quadrant = (float)k;
+    float r = radians - quadrant * 1.5703125f - quadrant * 4.83826794897e-4f;
+    float r2 = r * r;
+    float s = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+    float c = 1.0f - 0.5f * r2 + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+
+    float sine = (k & 1) ? c : s;
+    float cosine = (k & 1) ? s : c;
+    outSin = (k & 2) ? -sine : sine;
+    outCos = ((k + 1) & 2) ? -cosine : cosine;
+}
+
+// Angle of (x, y) in radians, in [-pi, pi]; 0 for (0, 0)
+inline float fastAtan2(float y, float x) {
+    float ax = std::fabs(x);
+    float ay = std::fabs(y);
+    float high = ax > ay ? ax : ay;
+    float low = ax > ay ? ay : ax;
+    float t = low / (high > 0.0f ? high : 1.0f);
+    float t2 = t * t;
+    float a = t * (0.99997726f + t2 * (-0.33262347f + t2 * (0.19354346f + t2 * (-0.11643287f +
+              t2 * (0.05265332f + t2 * -0.01172120f)))));
+    a = ay > ax ? FAST_HALF_PI - a : a;
+    a = x < 0.0f ? FAST_PI - a : a;
+    return std::copysign(a, y);
+}
+
+// fastSinCos and fastAtan2 over whole arrays (SSE2 where available, in
+// FastMath.cpp). Same results as calling them one value at a time.
+void fastSinCosArray(const float* radians, int count, float* outSin, float* outCos);
+void fastAtan2Array(const float* y, const float* x, int count, float* out);
@@ -0,0 +1,43 @@
+#pragma once
+
+// 16.16 fixed-point numbers stored in a plain int, plus integer-only trig.
+// Every operation here is exact integer math, so results are bit-identical on
+// any compiler, optimization level or -march flag. Used by the deterministic
+// (lockstep) simulation mode; see SimWorld::setDeterministic().
+typedef int Fixed;
+
+const int FIXED_SHIFT = 16;
+const Fixed FIXED_ONE = 1 << FIXED_SHIFT;
+
+// Angles are binary: a full turn is ANGLE_TURN units, and they wrap for free
+// when masked with ANGLE_MASK
+const int ANGLE_TURN = 65536;
+const int ANGLE_MASK = ANGLE_TURN - 1;
+const int ANGLE_QUARTER = ANGLE_TURN / 4;
+
+// float <-> fixed. Scaling by a power of two is exact, so both directions
+// round the same way everywhere.
+inline Fixed toFixed(float value) {
+    float scaled = value * (float)FIXED_ONE;
+    return (Fixed)(scaled < 0.0f ? scaled - 0.5f : scaled + 0.5f);
+}
+
+inline float fromFixed(Fixed value) {
+    return (float)value * (1.0f / FIXED_ONE);
+}
+
+inline Fixed fixedMul(Fixed a, Fixed b) {
+    return (Fixed)(((long long)a * b) >> FIXED_SHIFT);
+}
+
+inline Fixed fixedDiv(Fixed a, Fixed b) {
+    return (Fixed)(((long long)a << FIXED_SHIFT) / b);
+}
+
+Fixed fixedSqrt(Fixed value);                       // 0 for negative input
+Fixed fixedLength(Fixed x, Fixed y);                // sqrt(x * x + y * y) without overflow
+Fixed fixedSin(int angle);
+Fixed fixedCos(int angle);
+int fixedAtan2(Fixed y, Fixed x);                   // Binary angle, 0 = +x axis, counter-clockwise
+int angleFromDegrees(float degrees);                // For constants such as obstacle rotations
+float angleToRadians(int angle);                    // Display and float mode only; deterministic mode keeps the binary angle
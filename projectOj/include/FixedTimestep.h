@@ -0,0 +1,21 @@
+#pragma once
+
+// Accumulator that turns variable frame times into a whole number of fixed
+// simulation ticks. The remainder is exposed as an interpolation factor so the
+// renderer can blend between the previous and current tick.
+class FixedTimestep {
+public:
+    static const int DEFAULT_TICK_RATE = 60;
+
+    int tickRate;           // Ticks per second (60, 120, 128, ...)
+    float dt;               // Seconds per tick
+    double accumulator;     // Unsimulated time carried over between frames
+    double maxFrameTime;    // Frame time clamp so a stall doesn't trigger a burst of ticks
+
+    explicit FixedTimestep(int tickRate = DEFAULT_TICK_RATE);
+
+    void setTickRate(int hz);
+    int advance(double frameSeconds);   // Number of ticks to run for this frame
+    float alpha() const;                // Fraction of a tick left in the accumulator
+    void reset();
+};
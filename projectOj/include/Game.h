@@ -3,12 +3,19 @@
 #include <string>
 #include <vector>
 #include <map>
+#include "FixedTimestep.h"
+#include "EntityStore.h"
 
 class Player;
+struct PlayerBody;
 class Map;
 class Room;
 class Match;
-class Bullet;
+class SimWorld;
+class JobSystem;
+class Replay;
+class PeerLink;
+class RollbackSession;
 
 class Game {
 public:
@@ -24,17 +31,28 @@ public:
     };
 
     static MenuState menuState;
-    static Player* currentPlayer;
-    static Map* gameMap;
+    static EntityHandle currentPlayer;  // Local player's handle in the lobby
     static Room* currentRoom;
     static Match* currentMatch;
     static std::vector<Room*> rooms;
-    static std::vector<Bullet*> bullets;  // All active bullets
-    static std::vector<Player*> allPlayers;  // All players in the match
+    static EntityStore lobby;  // Players in rooms; a match copies its roster into its own world
+    static JobSystem* jobs;  // Worker threads for the simulation's parallel phases
+    static bool deterministic;  // Run matches in fixed-point lockstep mode (--deterministic)
+    static std::string recordPath;  // Save each match's replay here (--record), empty = off
+    static Replay* recording;       // Replay of the current match while recording
+    static PeerLink* link;          // Connection to the other player (--host/--join), nullptr offline
+    static RollbackSession* rollback;  // Runs the current match while linked
+    static FixedTimestep simClock;  // Fixed simulation rate, independent of frame rate
+    static int lastFrameTime;       // GLUT_ELAPSED_TIME of the previous frame (ms)
     
     // Mouse position for crosshair (screen coordinates)
     static float mouseX;
     static float mouseY;
+    static bool fireQueued;  // Click waiting to be sent with the next tick input
+    // Held movement keys as InputCmd bits; WASD and arrows tracked apart so
+    // releasing one doesn't cancel the other
+    static unsigned char heldKeys;
+    static unsigned char heldArrows;
     
     // Camera offset (for camera following player)
     static float cameraX;
@@ -45,7 +63,7 @@ public:
     static void runOpenGl(int argc, char** argv);
     static void display();
     static void idle();
-    static void timer(int value);
+    static void tickSimulation();
     static void keyPressed(unsigned char key, int x, int y);
     static void keyUp(unsigned char key, int x, int y);
     static void specialKeyPressed(int key, int x, int y);
@@ -54,13 +72,15 @@ public:
     static void mouseClick(int button, int state, int x, int y);
     static void drawText(float x, float y, const std::string& text);
     static void drawCrosshair(float x, float y);
-    static void updateBullets();
-    static void cleanupBullets();
-    static void checkBulletCollisions();
-    static void checkWinCondition();
+    static Player* localPlayer();  // In the current match's world if there is one, else the lobby
+    static PlayerBody* localBody();  // Same lookup for the player's per-tick state
+    static void saveRecording();
+    static int playReplay(const std::string& path);  // Re-simulate a replay headlessly (--replay)
     
     static Room* createRoom(const std::string& roomName, int maxPlayers);
     static bool joinRoom(int roomId);
     static void startMatch();
+    static void joinPeerMatch();    // Start the match the host announced
+    static void endRollback();
     static void requestRoomList();
 };
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include "FixedPoint.h"
+#include "FastMath.h"
+#include "ByteStream.h"
+
+// One player's commands for one simulation tick, as the front-end collects
+// them and the simulation consumes them: held movement keys and fire as bits,
+// the aim direction as a 16-bit binary angle (FixedPoint.h). Fits in 8 bytes
+// and goes over the network in 7.
+struct InputCmd {
+    static const unsigned char UP = 1;
+    static const unsigned char DOWN = 2;
+    static const unsigned char LEFT = 4;
+    static const unsigned char RIGHT = 8;
+    static const unsigned char FIRE = 16;     // Shoot a bullet this tick
+    static const unsigned char AIM = 32;      // aim carries a new direction
+    static const unsigned char MOVE_MASK = UP | DOWN | LEFT | RIGHT;
+    static const int WIRE_BYTES = 7;
+
+    unsigned int tick;          // Simulation tick the command is for
+    unsigned short aim;         // Binary angle of the aim direction, 0 = +x axis
+    unsigned char buttons;      // Bits above
+
+    InputCmd() : tick(0), aim(0), buttons(0) {}
+
+    bool held(unsigned char button) const {
+        return (buttons & button) != 0;
+    }
+
+    // Aim along (dx, dy), quantized to 1/65536 of a turn
+    void setAim(float dx, float dy) {
+        float turns = fastAtan2(dy, dx) * (1.0f / 6.28318531f);
+        aim = (unsigned short)((int)std::floor(turns * ANGLE_TURN + 0.5f) & ANGLE_MASK);
+        buttons |= AIM;
+    }
+
+    // Same effect on the simulation (aim only matters when AIM is set)
+    bool sameAs(const InputCmd& other) const {
+        return buttons == other.buttons && (!held(AIM) || aim == other.aim);
+    }
+
+    void write(std::vector<unsigned char>& out) const {
+        putU32(out, tick);
+        out.push_back(buttons);
+        putU16(out, aim);
+    }
+
+    bool read(ByteReader& reader) {
+        tick = reader.u32();
+        buttons = reader.u8();
+        aim = reader.u16();
+        return reader.ok;
+    }
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+// Fixed pool of worker threads with one job queue each. Workers take jobs from
+// the back of their own queue and steal from the front of the others' when
+// they run dry. The thread that calls parallelFor() works on the chunks too,
+// so a pool of N threads starts N - 1 workers and a pool of 1 runs everything
+// inline.
+class JobSystem {
+public:
+    typedef std::function<void(int begin, int end)> RangeJob;
+
+    explicit JobSystem(int threadCount = 1);
+    ~JobSystem();
+
+    int threadCount() const { return (int)queues.size(); }
+
+    // Run job over [0, count) in chunks of at most chunkSize items and wait for
+    // all of them. Chunks may run on any thread in any order, so job must only
+    // write data owned by its own range.
+    void parallelFor(int count, int chunkSize, const RangeJob& job);
+
+private:
+    struct Chunk {
+        const RangeJob* job;
+        int begin;
+        int end;
+        std::atomic<int>* remaining;    // Chunks of the same parallelFor still running
+    };
+
+    struct Queue {
+        std::mutex lock;
+        std::deque<Chunk> chunks;
+    };
+
+    std::vector<Queue*> queues;         // queues[0] belongs to the calling thread
+    std::vector<std::thread> workers;   // Worker i - 1 owns queues[i]
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    std::atomic<int> pending;           // Chunks queued but not yet taken
+    bool stopping;
+
+    bool popOwn(int queue, Chunk& out);
+    bool steal(int thief, Chunk& out);
+    bool take(int queue, Chunk& out);   // Own queue first, then steal
+    void run(const Chunk& chunk);
+    void workerLoop(int queue);
+};
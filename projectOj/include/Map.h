@@ -1,7 +1,12 @@
 #pragma once
 
 #include <vector>
+#include "RectBVH.h"
+#include "DistanceField.h"
+#include "SpawnPlanner.h"
+#ifndef OJ_HEADLESS
 #include <GL/freeglut.h>
+#endif
 
 class Rect {
 public:
@@ -19,6 +24,7 @@ public:
         this->bottom = bottom;
     }
     
+#ifndef OJ_HEADLESS
     void draw(float red = 0.5f, float green = 0.3f, float blue = 0.1f) const {
         glColor3f(red, green, blue);
         glBegin(GL_QUADS);
@@ -28,6 +34,7 @@ public:
             glVertex2f(right, top);
         glEnd();
     }
+#endif
     
     bool checkCollision(const Rect& other) const {
         if (other.right < left) return false;
@@ -49,19 +56,135 @@ public:
         
         return distanceSquared < radius * radius;
     }
+    
+    bool containsPoint(float x, float y) const {
+        return x >= left && x <= right && y >= bottom && y <= top;
+    }
+};
+
+// Solid rectangle of size width x height centered at (centerX, centerY) and
+// rotated counter-clockwise by angle degrees, the same transform render()
+// applies with glTranslatef/glRotatef/glScalef.
+class Obstacle {
+public:
+    float centerX;
+    float centerY;
+    float halfWidth;
+    float halfHeight;
+    float angle;        // Degrees
+    float cosAngle;
+    float sinAngle;
+    
+    // Fixed-point copy of the shape for deterministic mode (table trig, no libm)
+    Fixed fixedCenterX, fixedCenterY;
+    Fixed fixedHalfWidth, fixedHalfHeight;
+    Fixed fixedCosAngle, fixedSinAngle;
+    
+    Obstacle(float centerX, float centerY, float width, float height, float angle = 0.0f);
+    
+    // Exact distance from (x, y) to the rectangle, negative inside
+    float signedDistance(float x, float y) const;
+    Fixed signedDistanceFixed(Fixed x, Fixed y) const;
+    Rect bounds() const;    // Axis-aligned box around the rotated rectangle
+};
+
+// Result of a swept-circle query against the map. The sweep that ran fills
+// either the float or the fixed-point fields.
+struct SweepHit {
+    bool hit;
+    float time;         // Fraction of the move completed before contact (0..1)
+    float normalX;      // Surface normal at the contact point
+    float normalY;
+    float gap;          // Space left between the circle and the wall at contact
+    Fixed fixedTime;
+    Fixed fixedNormalX;
+    Fixed fixedNormalY;
+    Fixed fixedGap;
+    
+    SweepHit() : hit(false), time(1.0f), normalX(0.0f), normalY(0.0f), gap(0.0f),
+                 fixedTime(FIXED_ONE), fixedNormalX(0), fixedNormalY(0), fixedGap(0) {}
 };
 
 class Map {
 public:
     float width;
     float height;
-    std::vector<Rect> collisionRects;  // For collision detection only
+    std::vector<Obstacle> obstacles;   // Exact collision shapes, walls included
+    std::vector<Rect> collisionRects;  // collisionRects[i] bounds obstacles[i]
+    RectBVH collisionTree;             // Built over collisionRects in initializeMap()
+    DistanceField distanceField;       // Baked from obstacles over the map area
+    SpawnPlanner spawnPoints;          // Baked with the field; SimWorld::spawnPlayers() draws from it
+    
+    static const int FIELD_CELL_SIZE = 2;  // Spacing of distance field samples
+    static const int LAYOUT_ID = 1;        // Bump when initializeMap() changes; replays record it
+    static const int SPAWN_SPACING = 40;   // Minimum distance between spawn points
+    static const int SPAWN_RADIUS = 15;    // Player collision radius the spawn points leave room for
     
     Map(float w, float h);
-    void render();
+    
+    // Baked map of the width x height layout, built on first use and kept
+    // for the life of the process. Every world on that layout reads this one
+    // copy, so starting a match costs no bake. Thread-safe.
+    static const Map* shared(float w, float h);
+    
+#ifndef OJ_HEADLESS
+    void render() const;
+#endif
     void initializeMap();
+    void buildCollisionData();  // Rebuild the rects, tree, field and spawn points after changing obstacles
+    
+    // Signed distance to the nearest obstacle. Inside the map this is a field
+    // lookup; outside it falls back to distanceLinear().
+    float distanceAt(float x, float y) const;
+    float distanceLinear(float x, float y) const;  // Reference scan of every obstacle
+    
+    // Unit vector pointing away from the nearest surface (for sliding and
+    // ricochets). Returns false where the field is flat.
+    bool normalAt(float x, float y, float& outX, float& outY) const;
     
     // Collision detection
     bool checkCollision(float x, float y, float radius) const;
+    bool checkCollisionLinear(float x, float y, float radius) const;  // Reference scan of every obstacle
+    bool containsPoint(float x, float y) const;
+    
+    // Test count circles of the same radius at once: one batched field
+    // lookup (DistanceField::sampleBatch) for all of them. Bit i of hitMask
+    // (word i / 32, bit i % 32) is set when circle i overlaps an obstacle;
+    // the answers match checkCollision().
+    void checkCollisionBatch(const float* xs, const float* ys, int count, float radius,
+                             std::vector<unsigned int>& hitMask) const;
+    
+    // Distance a circle can travel from (x, y) along the unit direction
+    // (dirX, dirY) before it touches an obstacle, capped at maxDistance
+    float castCircle(float x, float y, float radius, float dirX, float dirY, float maxDistance) const;
+    
+    // Sphere-trace a circle along (dx, dy) through the field. Returns true
+    // with the time of impact and the wall's normal if it runs into a wall;
+    // moving away from or along a surface it touches is never a hit.
+    bool sweepCircle(float x, float y, float radius, float dx, float dy, SweepHit& hit) const;
+    
+    // Move a circle by (dx, dy), stopping at walls and sliding along them
+    void moveCircle(float& x, float& y, float radius, float dx, float dy) const;
     bool isValidSpawnPosition(float x, float y, float radius) const;
+    
+    // Fixed-point versions for the deterministic simulation mode. They only
+    // read fixed-point data, so every peer gets bit-identical answers.
+    Fixed distanceAtFixed(Fixed x, Fixed y) const;
+    bool normalAtFixed(Fixed x, Fixed y, Fixed& outX, Fixed& outY) const;
+    bool checkCollisionFixed(Fixed x, Fixed y, Fixed radius) const;
+    bool sweepCircleFixed(Fixed x, Fixed y, Fixed radius, Fixed dx, Fixed dy, SweepHit& hit) const;
+    void moveCircleFixed(Fixed& x, Fixed& y, Fixed radius, Fixed dx, Fixed dy) const;
+    bool isValidSpawnPositionFixed(Fixed x, Fixed y, Fixed radius) const;
+    Fixed castCircleFixed(Fixed x, Fixed y, Fixed radius, Fixed dirX, Fixed dirY, Fixed maxDistance) const;
+
+private:
+    bool overlapsExact(float x, float y, float radius) const;  // Tree query + exact obstacle test
+    
+    // The sweeps, starting from a known gap. sliding = the circle starts on
+    // the wall from the previous sweep and moves along it, so the start
+    // needs no normal test.
+    bool traceCircle(float x, float y, float radius, float dx, float dy, float gap, bool sliding,
+                     SweepHit& hit) const;
+    bool traceCircleFixed(Fixed x, Fixed y, Fixed radius, Fixed dx, Fixed dy, Fixed gap, bool sliding,
+                          SweepHit& hit) const;
 };
@@ -1,11 +1,15 @@
 #pragma once
 
 #include <vector>
+#include "EntityStore.h"
+#include "SimWorld.h"
 
-class Player;
-class Map;
 class Room;
+class Replay;
 
+// One match with its own SimWorld: players and bullets belong to this match
+// alone, so any number of matches can run side by side in a process. Matches
+// on the same layout share one read-only baked Map.
 class Match {
 public:
     enum MatchState {
@@ -17,18 +21,31 @@ public:
 
     int matchId;
     MatchState state;
-    Map* gameMap;
-    std::vector<Player*> players;
+    SimWorld* world;                        // Owned
+    std::vector<EntityHandle> players;      // Handles into world->entities
+    std::vector<EntityHandle> lobbyHandles; // Lobby handle each player was copied from
+    std::vector<PlayerInput> pendingInputs; // Consumed by the next update()
     Room* sourceRoom;
+    Replay* recording;                      // Not owned; nullptr = not recording
 
-    Match(int id, Room* room);
+    // Wall-clock cost of update(), for capacity planning
+    unsigned int ticksRun;
+    double lastTickMs;
+    double totalTickMs;
+    double maxTickMs;
+
+    // Copies the room's players out of the lobby into a new world of the given size
+    Match(int id, Room* room, const EntityStore& lobby, float width, float height);
     ~Match();
 
     void start();
-    void update();
+    void update();                          // Step the world once with pendingInputs
     void end();
     bool isActive() const;
-    void addPlayer(Player* player);
-    void removePlayer(Player* player);
+    EntityHandle addPlayer(const PlayerBody& body, const Player& player = Player(),
+                           EntityHandle lobbyHandle = INVALID_ENTITY);
+    void removePlayer(EntityHandle player);
+    EntityHandle worldHandle(EntityHandle lobbyHandle) const;  // INVALID_ENTITY if not in this match
+    double averageTickMs() const;
+    void printTickTimes() const;
 };
-
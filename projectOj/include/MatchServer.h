@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+#include "EntityStore.h"
+
+class Match;
+class Room;
+class JobSystem;
+
+// Hosts many independent matches in one process. Matches share no state, so
+// tick() updates them in parallel on the job system, one match per job; each
+// match's own world then runs serially on whichever thread picked it up.
+class MatchServer {
+public:
+    std::vector<Match*> matches;    // Owned
+    JobSystem* jobs;                // Not owned, nullptr = tick matches one after another
+    float mapWidth;
+    float mapHeight;
+    int tickRate;                   // Applied to every new match
+    bool deterministic;             // Likewise, see SimWorld::setDeterministic()
+    int nextMatchId;
+
+    MatchServer(float mapWidth, float mapHeight, JobSystem* jobs = nullptr);
+    ~MatchServer();
+
+    // Start a match for the room's players (copied out of lobby)
+    Match* createMatch(Room* room, const EntityStore& lobby);
+    Match* findMatch(int matchId);
+    void removeEndedMatches();
+
+    void tick();                    // Update every match once with its pending inputs
+    int activeCount() const;
+    void printTickTimes() const;
+};
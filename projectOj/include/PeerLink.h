@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include "SimWorld.h"
+
+// ENet's own forward declarations; enet.h stays out of headers so winsock
+// doesn't collide with the GL headers on Windows
+struct _ENetHost;
+struct _ENetPeer;
+
+class RollbackSession;
+
+// Connection to the other player of a peer-hosted LAN match. Match setup goes
+// over a reliable channel; tick inputs go over an unreliable one. Each input
+// packet acks the other side's inputs and repeats every local input the
+// other side hasn't acked yet, so a lost packet is covered by the next one
+// however many are lost in a row.
+class PeerLink {
+public:
+    static const int DEFAULT_PORT = 7777;
+    // Unacked inputs kept; older ones no longer fit the peer's input history
+    // (RollbackSession::HISTORY) anyway
+    static const int MAX_UNACKED = 64;
+    // Fixed roster of a linked match; each side only accepts inputs for the
+    // other side's id
+    static const int HOST_PLAYER_ID = 1;
+    static const int JOIN_PLAYER_ID = 2;
+    static const int CHANNEL_CONTROL = 0;   // Reliable
+    static const int CHANNEL_INPUT = 1;     // Unreliable, sequenced
+
+    _ENetHost* host;
+    _ENetPeer* peer;                        // The other player, nullptr until connected
+    bool hosting;
+    int remotePlayerId;                     // Player the peer plays as, bound when it connects
+    std::vector<PlayerInput> recentInputs;  // Local inputs the peer hasn't acked, oldest first
+    unsigned int peerAck;                   // The peer has all our inputs for ticks below this
+    unsigned int localAck;                  // We have all the peer's inputs for ticks below this
+    std::vector<PlayerInput> pendingInputs; // Received while there was no session, oldest first
+
+    // Match settings sent by the host with sendStart(); set on the joining side
+    bool startReceived;
+    unsigned int startSeed;
+    int startTickRate;
+    bool startDeterministic;
+
+    PeerLink();
+    ~PeerLink();
+
+    bool listen(int port);                  // Host: wait for the other player
+    bool connect(const std::string& address, int port);  // Join a host
+    bool isConnected() const;
+
+    // Handle network events; received inputs go to session, or wait in
+    // pendingInputs until a poll with a session (the joining side gets inputs
+    // before it has built its session)
+    void poll(RollbackSession* session);
+    void sendInput(const PlayerInput& input);  // input.tick says which tick it is for
+    void resendInputs();                    // Send the unacked inputs again, e.g. while waiting on the peer
+    void sendStart(unsigned int seed, int tickRate, bool deterministic);
+    void resetInputs();                     // Forget sent inputs before a new match
+
+private:
+    void receive(const unsigned char* bytes, size_t size, RollbackSession* session);
+    void bufferInput(const PlayerInput& input);
+};
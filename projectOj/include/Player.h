@@ -1,48 +1,53 @@
 #pragma once
-#include <GL/freeglut.h>
+
+#include "FixedPoint.h"
 
 class Bullet;
+class Map;
+struct InputCmd;
 
-class Player {
-public:
-    int id;
+// The part of a player every tick reads: movement, the spatial grid and hit
+// tests. EntityStore packs these into their own array (32 bytes, two per
+// cache line), apart from the rest of the player.
+struct PlayerBody {
     float x, y;
-    float speed;
+    // Deterministic mode (SimWorld::setDeterministic): these are authoritative
+    // and x, y are derived from them for rendering
+    Fixed fixedX, fixedY;
+    float speed;         // Units per second
     float size;
-    float angle;
-    bool isAlive;  // Whether player is still alive
+    int id;              // Hot because hit tests skip the bullet's owner by id
+    bool isAlive;        // Whether player is still alive
 
-    // Key state tracking for diagonal movement
-    bool keys[256];
-    bool keyUp;
-    bool keyDown;
-    bool keyLeft;
-    bool keyRight;
+    PlayerBody();
+    PlayerBody(int id, float x, float y);
+
+    void updateMovementWithCollision(const InputCmd& input, const Map* map, float dt);  // Movement with collision check
+    void updateMovementFixed(const InputCmd& input, const Map* map, Fixed dt);
+    void syncFixed();    // Load the fixed-point position from x and y
+    void eliminate();    // Mark player as eliminated
+};
+
+// Everything else about a player, kept in a separate array: aim (only read
+// when firing), match stats and render state
+class Player {
+public:
+    float prevX, prevY;  // Position at the start of the last tick (render interpolation)
+    float aimX, aimY;    // Unit aim direction; the arrow points along it
+    int fixedAngle;      // Binary angle of the aim direction, 0 = +x axis
+    int kills;           // Eliminations this match
 
     Player();
-    Player(int id, float x, float y);
-
-    void moveUp();
-    void moveDown();
-    void moveLeft();
-    void moveRight();
-    void moveUpRight();   // WD - diagonal up-right
-    void moveUpLeft();    // WA - diagonal up-left
-    void moveDownLeft();  // SA - diagonal down-left
-    void moveDownRight(); // SD - diagonal down-right
-    
-    void handleKey(unsigned char key, bool pressed);
-    void handleSpecialKey(int key, bool pressed);
-    void updateMovement();  // Process movement based on key states
-    void updateMovementWithCollision(bool (*checkCollision)(float x, float y, float radius));  // Movement with collision check
-    void updateAim(float mouseX, float mouseY);
-    void shoot(float mouseX, float mouseY);  // Shoot a bullet towards mouse position
-    void render();
-    void eliminate();  // Mark player as eliminated
-    
-    // Get bullet spawn position (slightly in front of player)
-    void getBulletSpawnPosition(float& outX, float& outY);
-    
-    // Movement helpers that check collision
-    bool tryMoveTo(float newX, float newY, bool (*checkCollision)(float x, float y, float radius));
+
+    void setAim(int aim);  // Binary angle of the aim direction (InputCmd::aim)
+    void syncFixed();      // Load fixedAngle from the aim direction
+
+#ifndef OJ_HEADLESS
+    void render(const PlayerBody& body);
+    void rotateToAim() const;  // Multiply the GL matrix by the rotation turning +y to the aim
+#endif
+
+    // Get bullet spawn position (slightly in front of the body)
+    void getBulletSpawnPosition(const PlayerBody& body, float& outX, float& outY) const;
+    void getBulletSpawnPositionFixed(const PlayerBody& body, Fixed& outX, Fixed& outY) const;
 };
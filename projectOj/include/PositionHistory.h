@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "FixedPoint.h"
+
+class EntityStore;
+
+// Where every player was over the last few ticks, for lag compensation: a
+// shot is tested against the targets as the shooter saw them, not as they
+// are now. One row per tick, indexed tick % capacity, with one column per
+// dense player index; the tick each row was recorded at is its timestamp.
+//
+// Positions are quantized to 16 bits over the map (1/32 unit on a 1600-unit
+// map), so a row costs 4 bytes per player.
+class PositionHistory {
+public:
+    static const int DEFAULT_TICKS = 32;        // Half a second at 60 Hz
+    static const unsigned int NO_TICK = 0xFFFFFFFFu;
+
+    int capacity;                               // Rows kept
+    int columns;                                // Players per row
+    int shift;                                  // Quantized = fixed-point position >> shift
+    std::vector<unsigned short> x, y;           // [row * columns + player]
+    std::vector<unsigned int> rowTick;          // Tick of each row, NO_TICK if empty
+
+    explicit PositionHistory(int ticks = DEFAULT_TICKS);
+
+    void setBounds(float width, float height);  // Picks the quantization step
+    void clear();
+    // Store every player's position at tick. Changing the player count clears
+    // the older rows, since their columns no longer line up.
+    void record(unsigned int tick, const EntityStore& entities, bool fixedPositions);
+    bool holds(unsigned int tick) const;
+
+    // Position of dense player index p ticksBack (fractional) ticks before
+    // tick, interpolated between the two recorded ticks around it. Rewinds
+    // past the oldest row stop at that row. Returns false, leaving outX/outY
+    // alone, if the player has no row at tick.
+    bool rewind(int p, unsigned int tick, Fixed ticksBack, Fixed& outX, Fixed& outY) const;
+    size_t memoryBytes() const;
+
+private:
+    Fixed positionX(unsigned int tick, int p) const;
+    Fixed positionY(unsigned int tick, int p) const;
+    unsigned short quantize(Fixed value) const;
+};
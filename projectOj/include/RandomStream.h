@@ -0,0 +1,36 @@
+#pragma once
+
+#include "FixedPoint.h"
+
+// What a random draw is for. Each subsystem gets its own streams, so adding
+// draws to one never shifts the numbers another sees. Append new values;
+// renumbering changes every recorded match.
+enum RandomSubsystem {
+    RANDOM_SPAWN = 1,       // Spawn point rotation at match start
+};
+
+// Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2,
+// 3"): a counter-based generator. Every block of four numbers is a pure
+// function of the key (match seed, subsystem) and the counter (entity, tick,
+// block index), so there is no shared state to lock and a stream gives the
+// same numbers no matter which thread creates it or in what order. Streams
+// are cheap to make; build one where the randomness is needed
+// (SimWorld::random) rather than keeping one around.
+class RandomStream {
+public:
+    RandomStream(unsigned int seed, unsigned int subsystem, unsigned int entity, unsigned int tick);
+
+    unsigned int next();                    // 32 random bits
+    unsigned int below(unsigned int bound); // Uniform in [0, bound), bound > 0
+    Fixed fixedUnit();                      // Uniform in [0, FIXED_ONE)
+    float unit();                           // Uniform in [0, 1)
+
+    // One Philox4x32-10 block
+    static void block(const unsigned int counter[4], const unsigned int key[2], unsigned int out[4]);
+
+private:
+    unsigned int key[2];
+    unsigned int counter[4];
+    unsigned int buffer[4];
+    int used;                               // Numbers of buffer already handed out
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+
+class Rect;
+
+// Static bounding volume hierarchy over a set of axis-aligned rectangles.
+// Built once from the map's collision rects; queries walk only the nodes whose
+// bounds overlap the query, so cost grows with log(rects) instead of rects.
+class RectBVH {
+public:
+    struct Node {
+        float minX, minY, maxX, maxY;   // Bounds of everything below this node
+        int first;                      // Leaf: first entry in order; inner: right child
+        int count;                      // Leaf: number of rects; inner: 0 (left child is next node)
+    };
+
+    static const int LEAF_SIZE = 4;
+
+    std::vector<Node> nodes;            // nodes[0] is the root
+    std::vector<int> order;             // Rect indices, leaves reference ranges
+
+    void build(const std::vector<Rect>& rects);
+    void clear();
+
+    bool overlapsCircle(const std::vector<Rect>& rects, float x, float y, float radius) const;
+    bool containsPoint(const std::vector<Rect>& rects, float x, float y) const;
+
+    // Collect indices of rects whose bounds overlap the box
+    void queryBox(const std::vector<Rect>& rects, float minX, float minY, float maxX, float maxY,
+                  std::vector<int>& out) const;
+
+private:
+    int buildNode(const std::vector<Rect>& rects, int begin, int end);
+};
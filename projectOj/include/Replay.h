@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include "SimWorld.h"
+
+class JobSystem;
+
+// Everything needed to re-run a match: its setup and every tick's inputs.
+// The simulation is a pure function of these, so playing the inputs back
+// reproduces the match exactly (bit-for-bit across builds in deterministic
+// mode, on the recording build otherwise).
+//
+// Inputs are packed per tick: an input count, then per input the player's
+// roster index, the InputCmd button byte, and the 16-bit aim angle only
+// when it changed since that player's previous input (and the lag
+// compensation view delay when it is non-zero).
+class Replay {
+public:
+    static const int VERSION = 2;
+
+    // Setup, captured by begin()
+    unsigned int seed;
+    int mapId;                      // Map::LAYOUT_ID of the recording build
+    float mapWidth;
+    float mapHeight;
+    int tickRate;
+    bool deterministic;
+    std::vector<int> roster;        // Player ids, in the world's order at match start
+
+    unsigned int tickCount;         // Ticks recorded
+    unsigned long long finalHash;   // SimWorld::stateHash() when recording finished
+    std::vector<unsigned char> data;  // Packed inputs, tickCount records
+
+    Replay();
+
+    // Recording: begin() after the world has spawned its players, then one
+    // recordTick() with the inputs of every step, then finish()
+    void begin(const SimWorld& world);
+    void recordTick(const std::vector<PlayerInput>& inputs);
+    void finish(const SimWorld& world);
+
+    // Unpack the tick record starting at data[offset]; returns the offset of
+    // the next one. lastAim carries aim between calls, one per roster entry.
+    size_t readTick(size_t offset, std::vector<PlayerInput>& inputs,
+                    std::vector<unsigned short>& lastAim) const;
+
+    void serialize(std::vector<unsigned char>& out) const;
+    bool deserialize(const unsigned char* bytes, size_t size);
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+private:
+    std::vector<int> recordedAim;   // Last aim written per roster entry, -1 before the first
+
+    int rosterIndex(int playerId) const;
+};
+
+// Re-simulates a Replay headlessly, as fast as the machine allows
+class ReplayPlayer {
+public:
+    const Replay& replay;
+    SimWorld* world;                // Owned, recreated by restart()
+    JobSystem* jobs;                // Not owned, nullptr = serial
+    size_t readOffset;              // Next tick record in replay.data
+    std::vector<PlayerInput> inputs;
+    std::vector<unsigned short> lastAim;
+
+    ReplayPlayer(const Replay& replay, JobSystem* jobs = nullptr);
+    ~ReplayPlayer();
+
+    void restart();                 // Back to the first tick, same setup as the recording
+    bool step();                    // Play one tick; false once every tick has been played
+    void seek(unsigned int tick);   // Fast-forward to tick, restarting first if it is behind
+    void runToEnd();
+    bool finished() const;
+    bool matchesRecording() const;  // Finished with the same state hash as the recording
+};
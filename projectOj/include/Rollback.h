@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+#include "SimWorld.h"
+#include "WorldSnapshot.h"
+
+// GGPO-style rollback for peer-to-peer matches. Every peer runs the whole
+// world. Inputs from remote players that haven't arrived yet are predicted
+// (they keep doing what they last did, minus firing); when the real input
+// arrives and differs from the prediction, advance() restores the snapshot
+// taken before that tick and re-simulates up to the present in one go.
+//
+// Peers only agree if their simulations are bit-identical, so sessions
+// between different builds or machines need deterministic mode.
+class RollbackSession {
+public:
+    static const int MAX_ROLLBACK = 12;     // Oldest tick a late input can still correct
+    static const int HISTORY = 64;          // Input rows kept; also bounds how far ahead inputs may arrive
+    static const unsigned int NO_ROLLBACK = 0xFFFFFFFFu;
+
+    SimWorld* world;                        // Not owned
+    SnapshotRing snapshots;                 // State before each of the last MAX_ROLLBACK + 1 ticks
+    std::vector<int> roster;                // Player ids; input column of each player
+    int localPlayerId;
+
+    // Input history, row = tick % HISTORY, one column per roster entry. Holds
+    // the input each tick was (or will be) simulated with, predicted or real.
+    std::vector<PlayerInput> inputs;
+    std::vector<unsigned char> confirmed;   // 1 where the real input is known
+    std::vector<unsigned int> rowTick;      // Tick each row currently describes
+    std::vector<PlayerInput> latestInput;   // Newest real input per player, basis of predictions
+    std::vector<unsigned int> latestTick;
+    std::vector<unsigned int> confirmedUntil;  // Per player: every tick below this is confirmed
+
+    unsigned int rollbackFrom;              // Earliest mispredicted tick, NO_ROLLBACK if none
+
+    // Cost of rollbacks, for tuning the frame budget
+    unsigned int rollbacks;
+    unsigned int resimulatedTicks;
+    unsigned int lateInputs;                // Arrived after MAX_ROLLBACK ticks and were dropped
+    double lastRollbackMs;
+    double maxRollbackMs;
+
+    // roster must list the world's players; maxBullets sizes the snapshots
+    RollbackSession(SimWorld* world, int localPlayerId, const std::vector<int>& roster,
+                    int maxBullets = BulletPool::DEFAULT_CAPACITY);
+
+    void addLocalInput(const PlayerInput& input);   // Input for the next tick, world->tick
+    // Real input of a remote player for input.tick. Returns false if it is too old to apply.
+    bool addRemoteInput(const PlayerInput& input);
+
+    // Correct any misprediction, then simulate one tick unless canAdvance() says to wait
+    void advance();
+    // False while this peer is MAX_ROLLBACK ticks ahead of the slowest player's
+    // confirmed input: any further and that player's inputs could no longer be
+    // rolled back. The caller should skip the tick so the other side catches up.
+    bool canAdvance() const;
+    unsigned int confirmedTick() const;     // Every player's input is known for ticks below this
+    unsigned int confirmedTickOf(int playerId) const;  // Same for one player; 0 if not in the roster
+    bool matchDecided() const;              // Match is over on confirmed inputs only
+
+private:
+    int column(int playerId) const;
+    int row(unsigned int tick);             // Row for tick, cleared first if it held another tick
+    void fillPredictions(int r);            // Predict every unconfirmed input in row r
+    void simulate(unsigned int tick);       // Snapshot, then step with the row of tick
+    std::vector<PlayerInput> frameInputs;   // Scratch for step()
+};
@@ -2,8 +2,7 @@
 
 #include <vector>
 #include <string>
-
-class Player;
+#include "EntityStore.h"
 
 class Room {
 public:
@@ -18,13 +17,13 @@ public:
     std::string roomName;
     int maxPlayers;
     RoomStatus status;
-    std::vector<Player*> players;
+    std::vector<EntityHandle> players;  // Handles into the lobby's EntityStore
 
     Room(int id, const std::string& name, int maxPlayers);
     ~Room();
 
-    bool addPlayer(Player* player);
-    bool removePlayer(Player* player);
+    bool addPlayer(EntityHandle player);
+    bool removePlayer(EntityHandle player);
     bool canJoin() const;
     bool isFull() const;
     int getPlayerCount() const;
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <vector>
+#include "BulletPool.h"
+#include "SpatialGrid.h"
+#include "EntityStore.h"
+#include "JobSystem.h"
+#include "PositionHistory.h"
+#include "InputCmd.h"
+#include "RandomStream.h"
+
+class Map;
+
+// A tick command as the simulation receives it: who it is from, plus the
+// lag compensation a server adds
+struct PlayerInput : InputCmd {
+    int playerId;
+    float viewDelay; // Ticks the player's view trails the simulation (lag compensation), set by the server
+
+    PlayerInput() : playerId(-1), viewDelay(0.0f) {}
+
+    bool sameAs(const PlayerInput& other) const {
+        return playerId == other.playerId && InputCmd::sameAs(other) && viewDelay == other.viewDelay;
+    }
+};
+
+// A player knocked out of the match
+struct EliminationEvent {
+    unsigned int tick;
+    int victimId;
+    int killerId;       // Owner of the bullet
+};
+
+// Headless match simulation: owns the players and bullets, reads a shared
+// baked map, and advances them one tick at a time. Contains no OpenGL/GLUT code so it can be driven by
+// the game window, a dedicated server, bots or benchmarks.
+class SimWorld {
+public:
+    float width;
+    float height;
+    const Map* gameMap;             // Shared with every world on the same layout, see Map::shared()
+    EntityStore entities;           // All players, dense; held elsewhere by handle
+    BulletPool bullets;             // All active bullets
+    SpatialGrid playerGrid;         // Live players bucketed by position after movement, rebuilt each tick
+    std::vector<int> gridCandidates;  // Scratch list for grid queries
+    std::vector<InputCmd> playerMoves;  // Movement input per dense player index, this tick
+    std::vector<int> bulletHits;    // Player index each bullet hits, -1 for none
+    std::vector<float> pushX, pushY;        // Separation push per dense player index, this tick
+    std::vector<Fixed> fixedPushX, fixedPushY;
+    PositionHistory history;        // Recent player positions, for rewinding lagged shots
+    JobSystem* jobs;                // Runs the parallel phases; not owned, nullptr = serial
+    unsigned int tick;              // Number of steps simulated so far
+    unsigned int seed;              // Match seed; any randomness must come from random() (replays record it)
+    int tickRate;                   // Steps per second
+    float dt;                       // Seconds simulated per step
+    bool deterministic;             // Fixed-point lockstep mode, see setDeterministic()
+    Fixed fixedDt;                  // dt in fixed point
+    bool matchOver;                 // Set once at most one player is left alive
+    int winnerId;                   // Id of the last player alive, -1 if none
+
+    // Kept up to date by eliminate() so nothing has to scan the players to
+    // count or find the survivors
+    std::vector<int> alivePlayers;  // Dense indices of live players, in no particular order
+    std::vector<int> aliveSlot;     // Position of each dense index in alivePlayers, -1 if out
+    std::vector<EliminationEvent> eliminations;  // Every elimination this match, in order (kill feed, stats)
+
+    // Work is split into chunks of this many items. Chunking only depends on
+    // these sizes, never on the thread count, so every thread count produces
+    // the same results. BULLET_CHUNK must be a multiple of 32 (BulletPool::updateRange).
+    static const int PLAYER_CHUNK = 16;
+    static const int BULLET_CHUNK = 512;
+
+    SimWorld(float w, float h);
+
+    void step(const std::vector<PlayerInput>& inputs);
+    void setTickRate(int hz);
+
+    // In deterministic mode players and bullets move in fixed point with table
+    // trig, so the same inputs give bit-identical results on every compiler
+    // and CPU. Peers can then run in lockstep and exchange only inputs.
+    void setDeterministic(bool enabled);
+    unsigned long long stateHash() const;  // Hash of all simulated state, for determinism checks
+
+    // Random numbers for entity (dense index, player id, or 0 for the world)
+    // at the current tick. Safe from any thread, and the same on every peer
+    // and replay whatever the thread count.
+    RandomStream random(RandomSubsystem subsystem, unsigned int entity) const;
+
+    EntityHandle addPlayer(const PlayerBody& body, const Player& player = Player());
+    bool removePlayer(EntityHandle handle);
+    Player* getPlayer(EntityHandle handle);
+    PlayerBody* getBody(EntityHandle handle);
+    int findPlayer(int id) const;   // Dense index of the player with this id, -1 if none
+    int aliveCount() const;
+    void eliminate(int index, int killerId);  // Knock out dense player index and record the event
+    // Recount the live players; needed after players were added, removed or
+    // overwritten wholesale (snapshots)
+    void rebuildAliveSet();
+    void discardEventsFrom(unsigned int tick);  // Forget eliminations at or after tick (rollback)
+    void spawnPlayers();            // Place all players on the map's spawn points
+    void reset();                   // Revive players and clear bullets for a new match
+    void clearBullets();
+    void clearPlayers(EntityHandle keep = INVALID_ENTITY);  // Destroy all players except keep
+    void retainPlayers(const std::vector<EntityHandle>& keep);  // Destroy players not listed
+
+    void buildPlayerGrid();
+    void spawnBullet(const PlayerBody& body, const Player& shooter, float viewDelay = 0.0f);
+    void scheduleWallHit(int i);    // Set bullet i's expiry to the tick its path meets a wall
+    void movePlayers(const std::vector<PlayerInput>& inputs);
+    // Push overlapping players apart: one pass, every pair moved by half its
+    // overlap, against positions from before the pass. Uses playerGrid, so
+    // call buildPlayerGrid() first. Each push is capped at the player's
+    // radius, which bounds how far anyone drifts from their grid cell.
+    void separatePlayers();
+    void updateBullets();
+    void checkBulletCollisions();
+    // Lowest-index live player bullet i overlaps (not its owner), -1 if none.
+    // Targets are rewound by the bullet's lag compensation; rewindReach widens
+    // the grid query per rewound tick.
+    int findBulletHit(int i, float reach, float rewindReach, std::vector<int>& candidates) const;
+    void cleanupBullets();
+    void checkWinCondition();
+
+private:
+    void parallelFor(int count, int chunkSize, const JobSystem::RangeJob& job);
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+
+// Uniform grid over the plane with cells hashed into a fixed-size table.
+// Items are points inserted with an integer index; after finish() the items of
+// each bucket are stored contiguously (counting sort), so the grid is rebuilt
+// every tick without allocating once the vectors have grown.
+//
+// Different cells can share a bucket, so queries may return items outside
+// the requested area; callers always run an exact narrowphase test.
+class SpatialGrid {
+public:
+    float cellSize;
+    int tableSize;                  // Number of hash buckets (power of two)
+
+    std::vector<int> bucketStart;   // Bucket b holds items[bucketStart[b] .. bucketStart[b + 1])
+    std::vector<int> items;         // Item indices sorted by bucket
+    std::vector<int> pendingItem;   // Inserted items before finish()
+    std::vector<int> pendingBucket;
+
+    explicit SpatialGrid(float cellSize = 64.0f, int tableSize = 1024);
+
+    int cellCoord(float v) const;
+    int bucket(int cellX, int cellY) const;
+
+    void begin();                               // Start a rebuild
+    void insert(int item, float x, float y);
+    void finish();                              // Sort inserted items into buckets
+
+    // Collect every item whose cell overlaps the box around (x, y), each once
+    void query(float x, float y, float radius, std::vector<int>& out) const;
+};
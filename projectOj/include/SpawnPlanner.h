@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include "FixedPoint.h"
+
+class Map;
+
+// Spawn points baked once when the map loads. build() scatters points over
+// the free floor with Poisson-disk sampling (Bridson), so any two are at
+// least `spacing` apart, then sorts them farthest-first: every prefix of the
+// list is spread as widely as the map allows. A match with N players takes
+// the first N points, so spawning is O(N) with no collision queries.
+//
+// Rosters too large for the map's spacing use one of the denser tiers baked
+// alongside it, each with about twice the points of the one before, down to
+// players just touching and then overlapping by half (separation pushes
+// them apart on the first tick).
+//
+// Everything is integer math from a fixed seed, so every build and both
+// simulation modes get the same points.
+struct SpawnTier {
+    Fixed spacing;                          // Minimum distance between points
+    std::vector<Fixed> x, y;                // Points in farthest-first order
+
+    int size() const { return (int)x.size(); }
+};
+
+class SpawnPlanner {
+public:
+    static const int CANDIDATES = 30;       // Tries around each active point (Bridson's k)
+
+    Fixed playerRadius;                     // Every point fits a circle this size
+    std::vector<SpawnTier> tiers;           // tiers[0] has the build() spacing, each next one is denser
+
+    SpawnPlanner();
+
+    void build(const Map& map, float spacing, float playerRadius);
+    int size() const;                       // Points in tiers[0]
+    int tierFor(int count) const;           // Sparsest tier with room for count players
+
+    // Spawn point of player index of count, from tierFor(count). The count
+    // points are shared out rotated by rotation, so with a random rotation
+    // the same roster starts in different places each match. If even the
+    // densest tier is short, later laps over the points are offset to a free
+    // spot beside them.
+    void pick(const Map& map, int index, int count, unsigned int rotation, Fixed& outX, Fixed& outY) const;
+
+private:
+    void sample(const Map& map, SpawnTier& tier) const;  // Poisson-disk points in discovery order
+    void orderFarthestFirst(SpawnTier& tier, Fixed centerX, Fixed centerY) const;
+};
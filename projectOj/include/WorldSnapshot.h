@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+class SimWorld;
+
+// Copy of everything SimWorld::step() carries from one tick to the next:
+// players and their handle tables, live bullets and the match flags. Each
+// array is plain data, so capture and restore are one memcpy per array into
+// and out of a single byte buffer, with no per-entity work. Scratch state the
+// tick rebuilds itself (spatial grid, hit lists) and settings (tick rate,
+// deterministic mode, jobs) are not included. Neither is the position
+// history: its rows before the restored tick are still right, and
+// re-simulating rewrites the later ones. restore() rebuilds the alive set from
+// the players and drops eliminations recorded after the snapshot.
+class WorldSnapshot {
+public:
+    unsigned int tick;                  // world->tick when captured
+    std::vector<unsigned char> bytes;   // Header followed by the arrays
+    size_t size;                        // Bytes in use
+
+    WorldSnapshot();
+
+    // Grow the buffer for worlds up to this size, so capture() never allocates
+    void reserve(int maxPlayers, int maxBullets);
+
+    void capture(const SimWorld& world);
+    void restore(SimWorld& world) const;
+
+    static size_t bytesNeeded(int players, int slots, int bullets);
+};
+
+// Fixed number of snapshots reused round-robin, one per tick: the snapshot of
+// tick t lives in slot t % capacity until tick t + capacity overwrites it
+class SnapshotRing {
+public:
+    std::vector<WorldSnapshot> slots;
+
+    SnapshotRing(int capacity, int maxPlayers, int maxBullets);
+
+    void save(const SimWorld& world);   // Snapshot the world's current tick
+    const WorldSnapshot* find(unsigned int tick) const;  // nullptr if not held any more
+    bool restore(SimWorld& world, unsigned int tick) const;  // false if tick is not held
+    int capacity() const;
+
+private:
+    std::vector<bool> used;
+};
@@ -1,4 +1,7 @@
 #include "Bullet.h"
+#ifndef OJ_HEADLESS
+#include <GL/freeglut.h>
+#endif
 #include <cmath>
 
 Bullet::Bullet() {
@@ -6,7 +9,7 @@ Bullet::Bullet() {
     y = 0.0f;
     vx = 0.0f;
     vy = 0.0f;
-    speed = 10.0f;
+    speed = 600.0f;
     size = 4.0f;
     active = false;
     ownerId = -1;
@@ -14,7 +17,7 @@ Bullet::Bullet() {
     maxLifetime = 3.0f;  // Bullets despawn after 3 seconds
 }
 
-Bullet::Bullet(float startX, float startY, float angle, int ownerId, float bulletSpeed) {
+Bullet::Bullet(float startX, float startY, float dirX, float dirY, int ownerId, float bulletSpeed) {
     this->x = startX;
     this->y = startY;
     this->ownerId = ownerId;
@@ -24,23 +27,19 @@ Bullet::Bullet(float startX, float startY, float angle, int ownerId, float bulle
     this->lifetime = 0.0f;
     this->maxLifetime = 3.0f;
     
-    // Calculate velocity based on angle
-    // Note: angle is already adjusted for the arrow pointing direction
-    // We need to add π/2 back to get the correct direction
-    float adjustedAngle = angle + 3.14159f / 2.0f;
-    vx = cos(adjustedAngle) * speed;
-    vy = sin(adjustedAngle) * speed;
+    vx = dirX * speed;
+    vy = dirY * speed;
 }
 
-void Bullet::update() {
+void Bullet::update(float dt) {
     if (!active) return;
     
     // Update position
-    x += vx;
-    y += vy;
+    x += vx * dt;
+    y += vy * dt;
     
     // Update lifetime
-    lifetime += 0.016f;  // Assuming ~60 FPS (16ms per frame)
+    lifetime += dt;
     
     // Deactivate if lifetime exceeded
     if (lifetime >= maxLifetime) {
@@ -48,11 +47,23 @@ void Bullet::update() {
     }
 }
 
+#ifndef OJ_HEADLESS
 void Bullet::render() {
     if (!active) return;
-    
-    // Calculate the angle of travel from velocity
-    float travelAngle = atan2(vy, vx);
+    draw(x, y, vx, vy, size);
+}
+
+void Bullet::draw(float x, float y, float vx, float vy, float size) {
+    // Rotate +x onto the direction of travel straight from the velocity
+    float speed = std::sqrt(vx * vx + vy * vy);
+    float dirX = speed > 0.0f ? vx / speed : 1.0f;
+    float dirY = speed > 0.0f ? vy / speed : 0.0f;
+    const GLfloat rotation[16] = {
+        dirX, dirY, 0.0f, 0.0f,
+        -dirY, dirX, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f,
+    };
     
     // Triangle size
     float triangleSize = size * 1.5f;  // Make triangle slightly larger than the old circle
@@ -60,7 +71,7 @@ void Bullet::render() {
     glColor3f(1.0f, 1.0f, 0.0f);  // Yellow color for bullets
     glPushMatrix();
     glTranslatef(x, y, 0.0f);
-    glRotatef(travelAngle * 180.0f / 3.14159f, 0.0f, 0.0f, 1.0f);
+    glMultMatrixf(rotation);
     
     // Draw a sharp triangle pointing forward (in direction of travel)
     glBegin(GL_TRIANGLES);
@@ -73,6 +84,7 @@ void Bullet::render() {
     
     glPopMatrix();
 }
+#endif
 
 bool Bullet::isOutOfBounds(int screenWidth, int screenHeight) {
     return x < 0 || x > screenWidth || y < 0 || y > screenHeight;
@@ -0,0 +1,229 @@
+#include "BulletPool.h"
+#include <cmath>
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+// Index of the lowest set bit (bits must be non-zero)
+static int lowestBit(unsigned int bits) {
+#if defined(__GNUC__)
+    return __builtin_ctz(bits);
+#else
+    int index = 0;
+    while ((bits & 1u) == 0) {
+        bits >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+BulletPool::BulletPool(int capacity)
+    : capacity(capacity), count(0), size(4.0f), maxLifetime(3.0f),
+      x(capacity), y(capacity), prevX(capacity), prevY(capacity), vx(capacity), vy(capacity),
+      lifetime(capacity), expiry(capacity), owner(capacity), active(capacity), deadMask((capacity + 31) / 32, 0u),
+      fixedX(capacity), fixedY(capacity), fixedVX(capacity), fixedVY(capacity), fixedLifetime(capacity), fixedExpiry(capacity), rewind(capacity) {
+}
+
+int BulletPool::spawn(float startX, float startY, float dirX, float dirY, int ownerId, float bulletSpeed) {
+    if (count >= capacity) {
+        return -1;  // Pool exhausted, drop the shot
+    }
+
+    int i = count++;
+    x[i] = startX;
+    y[i] = startY;
+    prevX[i] = startX;
+    prevY[i] = startY;
+
+    // (dirX, dirY) is a unit vector
+    vx[i] = dirX * bulletSpeed;
+    vy[i] = dirY * bulletSpeed;
+
+    lifetime[i] = 0.0f;
+    expiry[i] = maxLifetime;
+    owner[i] = ownerId;
+    active[i] = 1;
+    rewind[i] = 0;
+    return i;
+}
+
+int BulletPool::spawnFixed(Fixed startX, Fixed startY, int angle, int ownerId, Fixed bulletSpeed) {
+    if (count >= capacity) {
+        return -1;  // Pool exhausted, drop the shot
+    }
+
+    int i = count++;
+    fixedX[i] = startX;
+    fixedY[i] = startY;
+    fixedVX[i] = fixedMul(fixedCos(angle), bulletSpeed);
+    fixedVY[i] = fixedMul(fixedSin(angle), bulletSpeed);
+    fixedLifetime[i] = 0;
+    fixedExpiry[i] = toFixed(maxLifetime);
+
+    x[i] = fromFixed(startX);
+    y[i] = fromFixed(startY);
+    prevX[i] = x[i];
+    prevY[i] = y[i];
+    vx[i] = fromFixed(fixedVX[i]);
+    vy[i] = fromFixed(fixedVY[i]);
+    lifetime[i] = 0.0f;
+    expiry[i] = maxLifetime;
+    owner[i] = ownerId;
+    active[i] = 1;
+    rewind[i] = 0;
+    return i;
+}
+
+void BulletPool::update(float dt) {
+    updateRange(0, count, dt);
+}
+
+void BulletPool::updateRange(int begin, int end, float dt) {
+    // Work on raw pointers: stores through unsigned char may alias anything,
+    // which would otherwise force count and every array pointer to be reloaded
+    float* px = x.data();
+    float* py = y.data();
+    float* ppx = prevX.data();
+    float* ppy = prevY.data();
+    const float* pvx = vx.data();
+    const float* pvy = vy.data();
+    float* plife = lifetime.data();
+    const float* pexpiry = expiry.data();
+    const int n = end;
+    int i = begin;
+
+    // Lane groups of 8 or 4 never straddle a 32-bit mask word
+#if defined(__AVX2__)
+    const __m256 dt8 = _mm256_set1_ps(dt);
+    for (; i + 8 <= n; i += 8) {
+        __m256 bx = _mm256_loadu_ps(px + i);
+        __m256 by = _mm256_loadu_ps(py + i);
+        _mm256_storeu_ps(ppx + i, bx);
+        _mm256_storeu_ps(ppy + i, by);
+        _mm256_storeu_ps(px + i, _mm256_add_ps(bx, _mm256_mul_ps(_mm256_loadu_ps(pvx + i), dt8)));
+        _mm256_storeu_ps(py + i, _mm256_add_ps(by, _mm256_mul_ps(_mm256_loadu_ps(pvy + i), dt8)));
+        __m256 life = _mm256_add_ps(_mm256_loadu_ps(plife + i), dt8);
+        _mm256_storeu_ps(plife + i, life);
+
+        int lanes = _mm256_movemask_ps(_mm256_cmp_ps(life, _mm256_loadu_ps(pexpiry + i), _CMP_GE_OQ));
+        if (lanes) expire((unsigned int)lanes, i);
+    }
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+    const __m128 dt4 = _mm_set1_ps(dt);
+    for (; i + 4 <= n; i += 4) {
+        __m128 bx = _mm_loadu_ps(px + i);
+        __m128 by = _mm_loadu_ps(py + i);
+        _mm_storeu_ps(ppx + i, bx);
+        _mm_storeu_ps(ppy + i, by);
+        _mm_storeu_ps(px + i, _mm_add_ps(bx, _mm_mul_ps(_mm_loadu_ps(pvx + i), dt4)));
+        _mm_storeu_ps(py + i, _mm_add_ps(by, _mm_mul_ps(_mm_loadu_ps(pvy + i), dt4)));
+        __m128 life = _mm_add_ps(_mm_loadu_ps(plife + i), dt4);
+        _mm_storeu_ps(plife + i, life);
+
+        int lanes = _mm_movemask_ps(_mm_cmpge_ps(life, _mm_loadu_ps(pexpiry + i)));
+        if (lanes) expire((unsigned int)lanes, i);
+    }
+#endif
+
+    // Scalar tail (and everything on targets without SSE)
+    for (; i < n; i++) {
+        ppx[i] = px[i];
+        ppy[i] = py[i];
+        px[i] += pvx[i] * dt;
+        py[i] += pvy[i] * dt;
+        plife[i] += dt;
+        if (plife[i] >= pexpiry[i]) kill(i);
+    }
+}
+
+void BulletPool::updateScalar(float dt) {
+    for (int i = 0; i < count; i++) {
+        prevX[i] = x[i];
+        prevY[i] = y[i];
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        lifetime[i] += dt;
+        if (lifetime[i] >= expiry[i]) kill(i);
+    }
+}
+
+void BulletPool::updateFixedRange(int begin, int end, Fixed dt) {
+    for (int i = begin; i < end; i++) {
+        prevX[i] = x[i];
+        prevY[i] = y[i];
+        fixedX[i] += fixedMul(fixedVX[i], dt);
+        fixedY[i] += fixedMul(fixedVY[i], dt);
+        fixedLifetime[i] += dt;
+        x[i] = fromFixed(fixedX[i]);
+        y[i] = fromFixed(fixedY[i]);
+        lifetime[i] = fromFixed(fixedLifetime[i]);
+        if (fixedLifetime[i] >= fixedExpiry[i]) kill(i);
+    }
+}
+
+void BulletPool::expire(unsigned int lanes, int first) {
+    deadMask[first / 32] |= lanes << (first % 32);
+    while (lanes) {
+        active[first + lowestBit(lanes)] = 0;
+        lanes &= lanes - 1;
+    }
+}
+
+void BulletPool::kill(int i) {
+    active[i] = 0;
+    deadMask[i / 32] |= 1u << (i % 32);
+}
+
+void BulletPool::compact() {
+    // Visit dead slots in ascending order straight from the mask, filling each
+    // hole with the last live bullet. Gives the same order as a linear scan.
+    const int oldCount = count;
+    int n = count;
+    for (int w = 0; w * 32 < n; w++) {
+        unsigned int bits = deadMask[w];
+        while (bits) {
+            int i = w * 32 + lowestBit(bits);
+            bits &= bits - 1;
+            if (i >= n) break;
+
+            // Dead bullets at the end just drop off
+            while (n - 1 > i && (deadMask[(n - 1) / 32] & (1u << ((n - 1) % 32)))) {
+                n--;
+            }
+            int last = --n;
+            if (last == i) break;
+
+            x[i] = x[last];
+            y[i] = y[last];
+            prevX[i] = prevX[last];
+            prevY[i] = prevY[last];
+            vx[i] = vx[last];
+            vy[i] = vy[last];
+            lifetime[i] = lifetime[last];
+            expiry[i] = expiry[last];
+            owner[i] = owner[last];
+            active[i] = active[last];
+            fixedX[i] = fixedX[last];
+            fixedY[i] = fixedY[last];
+            fixedVX[i] = fixedVX[last];
+            fixedVY[i] = fixedVY[last];
+            fixedLifetime[i] = fixedLifetime[last];
+            fixedExpiry[i] = fixedExpiry[last];
+            rewind[i] = rewind[last];
+        }
+    }
+    count = n;
+
+    for (int w = 0; w * 32 < oldCount; w++) {
+        deadMask[w] = 0u;
+    }
+}
+
+void BulletPool::clear() {
+    for (int w = 0; w * 32 < count; w++) {
+        deadMask[w] = 0u;
+    }
+    count = 0;
+}
@@ -0,0 +1,249 @@
+#include "DistanceField.h"
+#include "Map.h"
+#include "RectBVH.h"
+#include <cmath>
+#include <algorithm>
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+DistanceField::DistanceField()
+    : originX(0.0f), originY(0.0f), cellSize(1.0f), columns(0), rows(0),
+      fixedOriginX(0), fixedOriginY(0), fixedCellSize(FIXED_ONE) {
+}
+
+void DistanceField::build(const std::vector<Obstacle>& obstacles, const std::vector<Rect>& bounds,
+                          const RectBVH& tree, float minX, float minY, float maxX, float maxY, float cellSize) {
+    this->originX = minX;
+    this->originY = minY;
+    this->cellSize = cellSize;
+    columns = (int)std::ceil((maxX - minX) / cellSize) + 1;
+    rows = (int)std::ceil((maxY - minY) / cellSize) + 1;
+    values.assign((size_t)columns * rows, 0.0f);
+    fixedValues.assign((size_t)columns * rows, 0);
+    fixedOriginX = toFixed(minX);
+    fixedOriginY = toFixed(minY);
+    fixedCellSize = toFixed(cellSize);
+
+    // The union of obstacles is the minimum of their distances. Only the
+    // obstacles near a block of samples can be the minimum there: distance
+    // changes by at most the distance moved, so no sample in the block is
+    // farther than U = (distance at the block center) + (half its diagonal)
+    // from some obstacle, and an obstacle whose box is more than U away can
+    // be skipped. The margin covers rounding and the fixed-point samples, so
+    // the result is the same as visiting every obstacle.
+    const float margin = 1.0f;
+    std::vector<int> nearby;
+    for (int blockRow = 0; blockRow < rows; blockRow += BLOCK) {
+        int rowEnd = std::min(blockRow + BLOCK, rows);
+        for (int blockColumn = 0; blockColumn < columns; blockColumn += BLOCK) {
+            int columnEnd = std::min(blockColumn + BLOCK, columns);
+            float left = originX + blockColumn * cellSize;
+            float right = originX + (columnEnd - 1) * cellSize;
+            float bottom = originY + blockRow * cellSize;
+            float top = originY + (rowEnd - 1) * cellSize;
+            float centerX = 0.5f * (left + right);
+            float centerY = 0.5f * (bottom + top);
+            float halfDiagonal = 0.5f * std::sqrt((right - left) * (right - left) + (top - bottom) * (top - bottom));
+
+            float upper = 1e30f;
+            for (const Obstacle& obstacle : obstacles) {
+                upper = std::min(upper, obstacle.signedDistance(centerX, centerY));
+            }
+            float reach = std::max(upper + halfDiagonal + margin, 0.0f);
+            nearby.clear();
+            tree.queryBox(bounds, left - reach, bottom - reach, right + reach, top + reach, nearby);
+            // Visit in obstacle order, as the full scan did
+            std::sort(nearby.begin(), nearby.end());
+
+            for (int r = blockRow; r < rowEnd; r++) {
+                float y = originY + r * cellSize;
+                for (int c = blockColumn; c < columnEnd; c++) {
+                    float x = originX + c * cellSize;
+                    float distance = 1e30f;
+                    for (int index : nearby) {
+                        distance = std::min(distance, obstacles[index].signedDistance(x, y));
+                    }
+                    values[(size_t)r * columns + c] = distance;
+
+                    // Integer-only twin of the float sample, identical on every machine
+                    Fixed fixedX = fixedOriginX + c * fixedCellSize;
+                    Fixed fixedY = fixedOriginY + r * fixedCellSize;
+                    Fixed fixedDistance = 0x7FFFFFFF;
+                    for (int index : nearby) {
+                        fixedDistance = std::min(fixedDistance, obstacles[index].signedDistanceFixed(fixedX, fixedY));
+                    }
+                    fixedValues[(size_t)r * columns + c] = fixedDistance;
+                }
+            }
+        }
+    }
+}
+
+void DistanceField::clear() {
+    columns = 0;
+    rows = 0;
+    values.clear();
+    fixedValues.clear();
+}
+
+bool DistanceField::covers(float x, float y) const {
+    if (columns < 2 || rows < 2) return false;
+    return x >= originX && x <= originX + (columns - 1) * cellSize &&
+           y >= originY && y <= originY + (rows - 1) * cellSize;
+}
+
+void DistanceField::locate(float x, float y, int& c, int& r, float& fx, float& fy) const {
+    float gx = (x - originX) / cellSize;
+    float gy = (y - originY) / cellSize;
+    gx = std::min(std::max(gx, 0.0f), (float)(columns - 1));
+    gy = std::min(std::max(gy, 0.0f), (float)(rows - 1));
+
+    // The last row/column has no cell after it, so use the one before
+    c = std::min((int)gx, columns - 2);
+    r = std::min((int)gy, rows - 2);
+    fx = gx - c;
+    fy = gy - r;
+}
+
+float DistanceField::sample(float x, float y) const {
+    int c, r;
+    float fx, fy;
+    locate(x, y, c, r, fx, fy);
+
+    const float* row0 = values.data() + (size_t)r * columns + c;
+    const float* row1 = row0 + columns;
+    float bottom = row0[0] + (row0[1] - row0[0]) * fx;
+    float top = row1[0] + (row1[1] - row1[0]) * fx;
+    return bottom + (top - bottom) * fy;
+}
+
+void DistanceField::sampleBatch(const float* xs, const float* ys, int count, float* out) const {
+    int i = 0;
+    if (columns >= 2 && rows >= 2) {
+        // Same steps as locate() and sample() in lanes. Clamping gx to the
+        // last cell before truncating matches std::min((int)gx, columns - 2).
+        const float* v = values.data();
+#if defined(__AVX2__)
+        const __m256 originX8 = _mm256_set1_ps(originX), originY8 = _mm256_set1_ps(originY);
+        const __m256 cell8 = _mm256_set1_ps(cellSize), zero8 = _mm256_setzero_ps();
+        const __m256 maxX8 = _mm256_set1_ps((float)(columns - 1)), maxY8 = _mm256_set1_ps((float)(rows - 1));
+        const __m256 lastX8 = _mm256_set1_ps((float)(columns - 2)), lastY8 = _mm256_set1_ps((float)(rows - 2));
+        const __m256i columns8 = _mm256_set1_epi32(columns), one8 = _mm256_set1_epi32(1);
+        for (; i + 8 <= count; i += 8) {
+            __m256 gx = _mm256_div_ps(_mm256_sub_ps(_mm256_loadu_ps(xs + i), originX8), cell8);
+            __m256 gy = _mm256_div_ps(_mm256_sub_ps(_mm256_loadu_ps(ys + i), originY8), cell8);
+            gx = _mm256_min_ps(_mm256_max_ps(gx, zero8), maxX8);
+            gy = _mm256_min_ps(_mm256_max_ps(gy, zero8), maxY8);
+            __m256i c = _mm256_cvttps_epi32(_mm256_min_ps(gx, lastX8));
+            __m256i r = _mm256_cvttps_epi32(_mm256_min_ps(gy, lastY8));
+            __m256 fx = _mm256_sub_ps(gx, _mm256_cvtepi32_ps(c));
+            __m256 fy = _mm256_sub_ps(gy, _mm256_cvtepi32_ps(r));
+
+            __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(r, columns8), c);
+            __m256i above = _mm256_add_epi32(index, columns8);
+            __m256 v00 = _mm256_i32gather_ps(v, index, 4);
+            __m256 v01 = _mm256_i32gather_ps(v, _mm256_add_epi32(index, one8), 4);
+            __m256 v10 = _mm256_i32gather_ps(v, above, 4);
+            __m256 v11 = _mm256_i32gather_ps(v, _mm256_add_epi32(above, one8), 4);
+            __m256 bottom = _mm256_add_ps(v00, _mm256_mul_ps(_mm256_sub_ps(v01, v00), fx));
+            __m256 top = _mm256_add_ps(v10, _mm256_mul_ps(_mm256_sub_ps(v11, v10), fx));
+            _mm256_storeu_ps(out + i, _mm256_add_ps(bottom, _mm256_mul_ps(_mm256_sub_ps(top, bottom), fy)));
+        }
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128 originX4 = _mm_set1_ps(originX), originY4 = _mm_set1_ps(originY);
+        const __m128 cell4 = _mm_set1_ps(cellSize), zero4 = _mm_setzero_ps();
+        const __m128 maxX4 = _mm_set1_ps((float)(columns - 1)), maxY4 = _mm_set1_ps((float)(rows - 1));
+        const __m128 lastX4 = _mm_set1_ps((float)(columns - 2)), lastY4 = _mm_set1_ps((float)(rows - 2));
+        for (; i + 4 <= count; i += 4) {
+            __m128 gx = _mm_div_ps(_mm_sub_ps(_mm_loadu_ps(xs + i), originX4), cell4);
+            __m128 gy = _mm_div_ps(_mm_sub_ps(_mm_loadu_ps(ys + i), originY4), cell4);
+            gx = _mm_min_ps(_mm_max_ps(gx, zero4), maxX4);
+            gy = _mm_min_ps(_mm_max_ps(gy, zero4), maxY4);
+            __m128i c = _mm_cvttps_epi32(_mm_min_ps(gx, lastX4));
+            __m128i r = _mm_cvttps_epi32(_mm_min_ps(gy, lastY4));
+            __m128 fx = _mm_sub_ps(gx, _mm_cvtepi32_ps(c));
+            __m128 fy = _mm_sub_ps(gy, _mm_cvtepi32_ps(r));
+
+            // SSE2 has no gather (or 32-bit multiply): fetch the corners per lane
+            alignas(16) int cs[4], rs[4];
+            alignas(16) float v00[4], v01[4], v10[4], v11[4];
+            _mm_store_si128((__m128i*)cs, c);
+            _mm_store_si128((__m128i*)rs, r);
+            for (int lane = 0; lane < 4; lane++) {
+                const float* row0 = v + (size_t)rs[lane] * columns + cs[lane];
+                v00[lane] = row0[0];
+                v01[lane] = row0[1];
+                v10[lane] = row0[columns];
+                v11[lane] = row0[columns + 1];
+            }
+            __m128 a = _mm_load_ps(v00), b = _mm_load_ps(v01);
+            __m128 d = _mm_load_ps(v10), e = _mm_load_ps(v11);
+            __m128 bottom = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), fx));
+            __m128 top = _mm_add_ps(d, _mm_mul_ps(_mm_sub_ps(e, d), fx));
+            _mm_storeu_ps(out + i, _mm_add_ps(bottom, _mm_mul_ps(_mm_sub_ps(top, bottom), fy)));
+        }
+#endif
+    }
+
+    // Scalar tail (and everything on targets without SSE)
+    for (; i < count; i++) {
+        out[i] = sample(xs[i], ys[i]);
+    }
+}
+
+void DistanceField::gradient(float x, float y, float& outX, float& outY) const {
+    int c, r;
+    float fx, fy;
+    locate(x, y, c, r, fx, fy);
+
+    // Derivative of the bilinear patch, so it agrees with sample()
+    const float* row0 = values.data() + (size_t)r * columns + c;
+    const float* row1 = row0 + columns;
+    outX = ((row0[1] - row0[0]) * (1.0f - fy) + (row1[1] - row1[0]) * fy) / cellSize;
+    outY = ((row1[0] - row0[0]) * (1.0f - fx) + (row1[1] - row0[1]) * fx) / cellSize;
+}
+
+bool DistanceField::coversFixed(Fixed x, Fixed y) const {
+    if (columns < 2 || rows < 2) return false;
+    return x >= fixedOriginX && x <= fixedOriginX + (columns - 1) * fixedCellSize &&
+           y >= fixedOriginY && y <= fixedOriginY + (rows - 1) * fixedCellSize;
+}
+
+void DistanceField::locateFixed(Fixed x, Fixed y, int& c, int& r, Fixed& fx, Fixed& fy) const {
+    Fixed gx = fixedDiv(x - fixedOriginX, fixedCellSize);
+    Fixed gy = fixedDiv(y - fixedOriginY, fixedCellSize);
+    gx = std::min(std::max(gx, 0), (columns - 1) * FIXED_ONE);
+    gy = std::min(std::max(gy, 0), (rows - 1) * FIXED_ONE);
+
+    c = std::min(gx >> FIXED_SHIFT, columns - 2);
+    r = std::min(gy >> FIXED_SHIFT, rows - 2);
+    fx = gx - c * FIXED_ONE;
+    fy = gy - r * FIXED_ONE;
+}
+
+Fixed DistanceField::sampleFixed(Fixed x, Fixed y) const {
+    int c, r;
+    Fixed fx, fy;
+    locateFixed(x, y, c, r, fx, fy);
+
+    const Fixed* row0 = fixedValues.data() + (size_t)r * columns + c;
+    const Fixed* row1 = row0 + columns;
+    Fixed bottom = row0[0] + fixedMul(row0[1] - row0[0], fx);
+    Fixed top = row1[0] + fixedMul(row1[1] - row1[0], fx);
+    return bottom + fixedMul(top - bottom, fy);
+}
+
+void DistanceField::gradientFixed(Fixed x, Fixed y, Fixed& outX, Fixed& outY) const {
+    int c, r;
+    Fixed fx, fy;
+    locateFixed(x, y, c, r, fx, fy);
+
+    const Fixed* row0 = fixedValues.data() + (size_t)r * columns + c;
+    const Fixed* row1 = row0 + columns;
+    Fixed slopeX = fixedMul(row0[1] - row0[0], FIXED_ONE - fy) + fixedMul(row1[1] - row1[0], fy);
+    Fixed slopeY = fixedMul(row1[0] - row0[0], FIXED_ONE - fx) + fixedMul(row1[1] - row0[1], fx);
+    outX = fixedDiv(slopeX, fixedCellSize);
+    outY = fixedDiv(slopeY, fixedCellSize);
+}
@@ -0,0 +1,127 @@
+#include "EntityStore.h"
+#include <algorithm>
+
+unsigned int EntityStore::slotOf(EntityHandle handle) {
+    return handle & SLOT_MASK;
+}
+
+unsigned int EntityStore::generationOf(EntityHandle handle) {
+    return handle >> SLOT_BITS;
+}
+
+EntityHandle EntityStore::create(const PlayerBody& body, const Player& player) {
+    unsigned int slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = (unsigned int)slotDense.size();
+        if (slot > SLOT_MASK) {
+            return INVALID_ENTITY;  // Out of slots
+        }
+        slotDense.push_back(-1);
+        slotGeneration.push_back(1);
+    }
+
+    EntityHandle handle = (slotGeneration[slot] << SLOT_BITS) | slot;
+    slotDense[slot] = (int)players.size();
+    if (body.id >= 0) {
+        if (body.id >= (int)idDense.size()) idDense.resize(body.id + 1, -1);
+        idDense[body.id] = (int)players.size();
+    }
+    bodies.push_back(body);
+    players.push_back(player);
+    denseHandle.push_back(handle);
+    return handle;
+}
+
+bool EntityStore::destroy(EntityHandle handle) {
+    int index = indexOf(handle);
+    if (index < 0) return false;
+
+    int id = bodies[index].id;
+    if (id >= 0 && id < (int)idDense.size() && idDense[id] == index) {
+        idDense[id] = -1;
+    }
+
+    // Swap the last entity into the hole to keep the arrays dense
+    int last = (int)players.size() - 1;
+    if (index != last) {
+        bodies[index] = bodies[last];
+        players[index] = players[last];
+        denseHandle[index] = denseHandle[last];
+        slotDense[slotOf(denseHandle[index])] = index;
+        int movedId = bodies[index].id;
+        if (movedId >= 0 && movedId < (int)idDense.size() && idDense[movedId] == last) {
+            idDense[movedId] = index;
+        }
+    }
+    bodies.pop_back();
+    players.pop_back();
+    denseHandle.pop_back();
+
+    // Retire the slot; skip generation 0 so INVALID_ENTITY never resolves
+    unsigned int slot = slotOf(handle);
+    slotDense[slot] = -1;
+    unsigned int generation = (slotGeneration[slot] + 1) & GENERATION_MASK;
+    slotGeneration[slot] = (generation == 0) ? 1 : generation;
+    freeSlots.push_back(slot);
+    return true;
+}
+
+bool EntityStore::isValid(EntityHandle handle) const {
+    return indexOf(handle) >= 0;
+}
+
+int EntityStore::indexOf(EntityHandle handle) const {
+    unsigned int slot = slotOf(handle);
+    if (handle == INVALID_ENTITY || slot >= slotDense.size()) return -1;
+    if (slotGeneration[slot] != generationOf(handle)) return -1;
+    return slotDense[slot];
+}
+
+int EntityStore::indexOfId(int id) const {
+    if (id < 0 || id >= (int)idDense.size()) return -1;
+    return idDense[id];
+}
+
+void EntityStore::rebuildIdIndex() {
+    std::fill(idDense.begin(), idDense.end(), -1);
+    for (int i = 0; i < (int)bodies.size(); i++) {
+        int id = bodies[i].id;
+        if (id < 0) continue;
+        if (id >= (int)idDense.size()) idDense.resize(id + 1, -1);
+        idDense[id] = i;
+    }
+}
+
+Player* EntityStore::get(EntityHandle handle) {
+    int index = indexOf(handle);
+    return (index < 0) ? nullptr : &players[index];
+}
+
+const Player* EntityStore::get(EntityHandle handle) const {
+    int index = indexOf(handle);
+    return (index < 0) ? nullptr : &players[index];
+}
+
+PlayerBody* EntityStore::body(EntityHandle handle) {
+    int index = indexOf(handle);
+    return (index < 0) ? nullptr : &bodies[index];
+}
+
+const PlayerBody* EntityStore::body(EntityHandle handle) const {
+    int index = indexOf(handle);
+    return (index < 0) ? nullptr : &bodies[index];
+}
+
+int EntityStore::size() const {
+    return (int)bodies.size();
+}
+
+void EntityStore::clear() {
+    // Destroy one by one so every outstanding handle is invalidated
+    while (!denseHandle.empty()) {
+        destroy(denseHandle.back());
+    }
+}
@@ -0,0 +1,83 @@
+#include "FastMath.h"
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+void fastSinCosArray(const float* radians, int count, float* outSin, float* outCos) {
+    int i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+    // The selects in fastSinCos become masks: the quadrant's bits pick sine
+    // or cosine and flip signs by xor-ing the sign bit
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+    for (; i + 4 <= count; i += 4) {
+        __m128 angle = _mm_loadu_ps(radians + i);
+        __m128 scaled = _mm_mul_ps(angle, _mm_set1_ps(0.636619772f));
+        __m128 negative = _mm_cmplt_ps(scaled, zero);
+        __m128 half = _mm_or_ps(_mm_and_ps(negative, _mm_set1_ps(-0.5f)), _mm_andnot_ps(negative, _mm_set1_ps(0.5f)));
+        __m128i k = _mm_cvttps_epi32(_mm_add_ps(scaled, half));
+        __m128 quadrant = _mm_cvtepi32_ps(k);
+        __m128 r = _mm_sub_ps(_mm_sub_ps(angle, _mm_mul_ps(quadrant, _mm_set1_ps(1.5703125f))),
+                              _mm_mul_ps(quadrant, _mm_set1_ps(4.83826794897e-4f)));
+        __m128 r2 = _mm_mul_ps(r, r);
+
+        __m128 s = _mm_add_ps(_mm_set1_ps(8.3321608736e-3f), _mm_mul_ps(r2, _mm_set1_ps(-1.9515295891e-4f)));
+        s = _mm_add_ps(_mm_set1_ps(-1.6666654611e-1f), _mm_mul_ps(r2, s));
+        s = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), s));
+        __m128 c = _mm_add_ps(_mm_set1_ps(-1.388731625493765e-3f), _mm_mul_ps(r2, _mm_set1_ps(2.443315711809948e-5f)));
+        c = _mm_add_ps(_mm_set1_ps(4.166664568298827e-2f), _mm_mul_ps(r2, c));
+        c = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), r2)),
+                       _mm_mul_ps(_mm_mul_ps(r2, r2), c));
+
+        __m128 odd = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(k, one), one));
+        __m128 sine = _mm_or_ps(_mm_and_ps(odd, c), _mm_andnot_ps(odd, s));
+        __m128 cosine = _mm_or_ps(_mm_and_ps(odd, s), _mm_andnot_ps(odd, c));
+        __m128 flipSin = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(k, two), two));
+        __m128 flipCos = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_add_epi32(k, one), two), two));
+        _mm_storeu_ps(outSin + i, _mm_xor_ps(sine, _mm_and_ps(flipSin, signBit)));
+        _mm_storeu_ps(outCos + i, _mm_xor_ps(cosine, _mm_and_ps(flipCos, signBit)));
+    }
+#endif
+
+    // Scalar tail (and everything on targets without SSE)
+    for (; i < count; i++) {
+        fastSinCos(radians[i], outSin[i], outCos[i]);
+    }
+}
+
+void fastAtan2Array(const float* y, const float* x, int count, float* out) {
+    int i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    for (; i + 4 <= count; i += 4) {
+        __m128 vy = _mm_loadu_ps(y + i);
+        __m128 vx = _mm_loadu_ps(x + i);
+        __m128 ax = _mm_andnot_ps(signBit, vx);
+        __m128 ay = _mm_andnot_ps(signBit, vy);
+        __m128 high = _mm_max_ps(ax, ay);           // ax > ay ? ax : ay
+        __m128 low = _mm_min_ps(ay, ax);            // ax > ay ? ay : ax
+        __m128 positive = _mm_cmpgt_ps(high, zero);
+        __m128 divisor = _mm_or_ps(_mm_and_ps(positive, high), _mm_andnot_ps(positive, _mm_set1_ps(1.0f)));
+        __m128 t = _mm_div_ps(low, divisor);
+        __m128 t2 = _mm_mul_ps(t, t);
+
+        __m128 a = _mm_add_ps(_mm_set1_ps(0.05265332f), _mm_mul_ps(t2, _mm_set1_ps(-0.01172120f)));
+        a = _mm_add_ps(_mm_set1_ps(-0.11643287f), _mm_mul_ps(t2, a));
+        a = _mm_add_ps(_mm_set1_ps(0.19354346f), _mm_mul_ps(t2, a));
+        a = _mm_add_ps(_mm_set1_ps(-0.33262347f), _mm_mul_ps(t2, a));
+        a = _mm_mul_ps(t, _mm_add_ps(_mm_set1_ps(0.99997726f), _mm_mul_ps(t2, a)));
+
+        __m128 steep = _mm_cmpgt_ps(ay, ax);
+        a = _mm_or_ps(_mm_and_ps(steep, _mm_sub_ps(_mm_set1_ps(FAST_HALF_PI), a)), _mm_andnot_ps(steep, a));
+        __m128 left = _mm_cmplt_ps(vx, zero);
+        a = _mm_or_ps(_mm_and_ps(left, _mm_sub_ps(_mm_set1_ps(FAST_PI), a)), _mm_andnot_ps(left, a));
+        _mm_storeu_ps(out + i, _mm_or_ps(_mm_andnot_ps(signBit, a), _mm_and_ps(signBit, vy)));
+    }
+#endif
+
+    for (; i < count; i++) {
+        out[i] = fastAtan2(y[i], x[i]);
+    }
+}
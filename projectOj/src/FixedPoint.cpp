@@ -0,0 +1,126 @@
+#include "FixedPoint.h"
+#include <vector>
+
+// Quarter-wave sine table: entry k is sin(k / SINE_STEPS * pi / 2)
+static const int SINE_STEPS = 1024;
+static const int SINE_INDEX_SHIFT = 4;              // ANGLE_QUARTER / SINE_STEPS == 1 << 4
+
+static unsigned long long isqrt64(unsigned long long value) {
+    // Bit-by-bit square root, rounds down
+    unsigned long long result = 0;
+    unsigned long long bit = 1ull << 62;
+    while (bit > value) bit >>= 2;
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return result;
+}
+
+// Built with integer arithmetic only (Taylor series in Q30), never with libm,
+// so every machine gets the same table
+static std::vector<Fixed> buildSineTable() {
+    const long long Q30 = 1ll << 30;
+    const long long halfPiQ30 = 1686629713ll;       // pi / 2 * 2^30
+
+    std::vector<Fixed> table(SINE_STEPS + 1);
+    for (int k = 0; k <= SINE_STEPS; k++) {
+        long long x = halfPiQ30 * k / SINE_STEPS;
+        long long x2 = (x * x) >> 30;
+
+        // sin x = x (1 - x^2/6 (1 - x^2/20 (1 - x^2/42 (1 - x^2/72 (1 - x^2/110 (1 - x^2/156))))))
+        const int divisors[] = {156, 110, 72, 42, 20, 6};
+        long long series = Q30;
+        for (int divisor : divisors) {
+            series = Q30 - ((x2 * series) >> 30) / divisor;
+        }
+        long long sine = (x * series) >> 30;
+        table[k] = (Fixed)((sine + (1ll << 13)) >> 14);   // Q30 -> Q16, rounded
+    }
+    return table;
+}
+
+static const std::vector<Fixed>& sineTable() {
+    static const std::vector<Fixed> table = buildSineTable();
+    return table;
+}
+
+Fixed fixedSqrt(Fixed value) {
+    if (value <= 0) return 0;
+    return (Fixed)isqrt64((unsigned long long)value << FIXED_SHIFT);
+}
+
+Fixed fixedLength(Fixed x, Fixed y) {
+    // Squares of 16.16 values are 32.32; the root of that is back in 16.16
+    unsigned long long squared = (unsigned long long)((long long)x * x) + (unsigned long long)((long long)y * y);
+    return (Fixed)isqrt64(squared);
+}
+
+// Sine over the first quadrant, interpolating between table entries
+static Fixed quarterSine(int angle) {
+    const std::vector<Fixed>& table = sineTable();
+    int index = angle >> SINE_INDEX_SHIFT;
+    int fraction = angle & ((1 << SINE_INDEX_SHIFT) - 1);
+    if (index >= SINE_STEPS) return table[SINE_STEPS];
+    return table[index] + (((table[index + 1] - table[index]) * fraction) >> SINE_INDEX_SHIFT);
+}
+
+Fixed fixedSin(int angle) {
+    angle &= ANGLE_MASK;
+    int quadrant = angle / ANGLE_QUARTER;
+    int offset = angle % ANGLE_QUARTER;
+    switch (quadrant) {
+        case 0: return quarterSine(offset);
+        case 1: return quarterSine(ANGLE_QUARTER - offset);
+        case 2: return -quarterSine(offset);
+        default: return -quarterSine(ANGLE_QUARTER - offset);
+    }
+}
+
+Fixed fixedCos(int angle) {
+    return fixedSin(angle + ANGLE_QUARTER);
+}
+
+int fixedAtan2(Fixed y, Fixed x) {
+    if (x == 0 && y == 0) return 0;
+
+    long long ax = x < 0 ? -(long long)x : x;
+    long long ay = y < 0 ? -(long long)y : y;
+    bool steep = ay > ax;
+    long long along = steep ? ay : ax;      // Larger component
+    long long across = steep ? ax : ay;     // Smaller component
+
+    // Largest table step k (at most 45 degrees) with tan(k) <= across / along,
+    // comparing sin(k) * along <= cos(k) * across to avoid a division
+    const std::vector<Fixed>& table = sineTable();
+    int low = 0;
+    int high = SINE_STEPS / 2;
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+        if (table[mid] * along <= table[SINE_STEPS - mid] * across) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    int angle = low << SINE_INDEX_SHIFT;
+
+    if (steep) angle = ANGLE_QUARTER - angle;
+    if (x < 0) angle = ANGLE_TURN / 2 - angle;
+    if (y < 0) angle = -angle;
+    return angle & ANGLE_MASK;
+}
+
+int angleFromDegrees(float degrees) {
+    float units = degrees * (ANGLE_TURN / 360.0f);
+    return (int)(units < 0.0f ? units - 0.5f : units + 0.5f) & ANGLE_MASK;
+}
+
+float angleToRadians(int angle) {
+    return (float)angle * (6.28318531f / ANGLE_TURN);
+}
@@ -0,0 +1,33 @@
+#include "FixedTimestep.h"
+
+FixedTimestep::FixedTimestep(int tickRate)
+    : tickRate(DEFAULT_TICK_RATE), dt(1.0f / DEFAULT_TICK_RATE), accumulator(0.0), maxFrameTime(0.25) {
+    setTickRate(tickRate);
+}
+
+void FixedTimestep::setTickRate(int hz) {
+    if (hz <= 0) return;
+    tickRate = hz;
+    dt = 1.0f / hz;
+}
+
+int FixedTimestep::advance(double frameSeconds) {
+    if (frameSeconds < 0.0) frameSeconds = 0.0;
+    if (frameSeconds > maxFrameTime) frameSeconds = maxFrameTime;
+
+    accumulator += frameSeconds;
+    int ticks = 0;
+    while (accumulator >= dt) {
+        accumulator -= dt;
+        ticks++;
+    }
+    return ticks;
+}
+
+float FixedTimestep::alpha() const {
+    return (float)(accumulator / dt);
+}
+
+void FixedTimestep::reset() {
+    accumulator = 0.0;
+}
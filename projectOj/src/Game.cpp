@@ -4,30 +4,128 @@
 #include "Room.h"
 #include "Match.h"
 #include "Bullet.h"
+#include "SimWorld.h"
+#include "JobSystem.h"
+#include "Replay.h"
+#include "PeerLink.h"
+#include "Rollback.h"
 #include "Sound.h"
 #include <GL/freeglut.h>
 #include <iostream>
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <chrono>
+#include <ctime>
 
 int Game::width = 0;
 int Game::height = 0;
 Game::MenuState Game::menuState = Game::NONE;
-Player* Game::currentPlayer = nullptr;
-Map* Game::gameMap = nullptr;
+EntityHandle Game::currentPlayer = INVALID_ENTITY;
 Room* Game::currentRoom = nullptr;
 Match* Game::currentMatch = nullptr;
 std::vector<Room*> Game::rooms;
-std::vector<Bullet*> Game::bullets;
-std::vector<Player*> Game::allPlayers;
+EntityStore Game::lobby;
+JobSystem* Game::jobs = nullptr;
+bool Game::deterministic = false;
+std::string Game::recordPath;
+Replay* Game::recording = nullptr;
+PeerLink* Game::link = nullptr;
+RollbackSession* Game::rollback = nullptr;
 float Game::mouseX = 0.0f;
 float Game::mouseY = 0.0f;
+bool Game::fireQueued = false;
+unsigned char Game::heldKeys = 0;
+unsigned char Game::heldArrows = 0;
+FixedTimestep Game::simClock;
+int Game::lastFrameTime = 0;
+
+// Kill feed shows this many of the latest eliminations for this long
+static const int KILL_FEED_LINES = 4;
+static const float KILL_FEED_SECONDS = 4.0f;
+
+static float lerp(float from, float to, float t) {
+    return from + (to - from) * t;
+}
+
 float Game::cameraX = 0.0f;
 float Game::cameraY = 0.0f;
 
+// InputCmd movement bit of a WASD key, 0 for any other key
+static unsigned char movementButton(unsigned char key) {
+    switch (key) {
+        case 'w': case 'W': return InputCmd::UP;
+        case 's': case 'S': return InputCmd::DOWN;
+        case 'a': case 'A': return InputCmd::LEFT;
+        case 'd': case 'D': return InputCmd::RIGHT;
+    }
+    return 0;
+}
+
+static unsigned char arrowButton(int key) {
+    switch (key) {
+        case GLUT_KEY_UP: return InputCmd::UP;
+        case GLUT_KEY_DOWN: return InputCmd::DOWN;
+        case GLUT_KEY_LEFT: return InputCmd::LEFT;
+        case GLUT_KEY_RIGHT: return InputCmd::RIGHT;
+    }
+    return 0;
+}
+
 Game::Game(int w, int h, int argc, char** argv) {
     width = w;
     height = h;
+    
+    // --tickrate <hz>: simulation rate (60, 120, 128, ...), rendering is unaffected
+    // --threads <n>: simulation worker threads, defaults to one per core
+    // --deterministic: fixed-point simulation, identical on every machine
+    // --record <file>: save a replay of each match
+    // --replay <file>: re-simulate a recorded match without a window and exit
+    // --host <port>: host a two-player LAN match with rollback
+    // --join <address[:port]>: join one
+    int threads = (int)std::thread::hardware_concurrency();
+    std::string replayPath;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--deterministic") {
+            deterministic = true;
+        }
+        if (i + 1 >= argc) break;
+        if (std::string(argv[i]) == "--tickrate") {
+            simClock.setTickRate(std::atoi(argv[i + 1]));
+        }
+        if (std::string(argv[i]) == "--threads") {
+            threads = std::atoi(argv[i + 1]);
+        }
+        if (std::string(argv[i]) == "--record") {
+            recordPath = argv[i + 1];
+        }
+        if (std::string(argv[i]) == "--replay") {
+            replayPath = argv[i + 1];
+        }
+        if (std::string(argv[i]) == "--host") {
+            link = new PeerLink();
+            link->listen(std::atoi(argv[i + 1]));
+        }
+        if (std::string(argv[i]) == "--join") {
+            std::string address = argv[i + 1];
+            int port = PeerLink::DEFAULT_PORT;
+            size_t colon = address.find(':');
+            if (colon != std::string::npos) {
+                port = std::atoi(address.c_str() + colon + 1);
+                address = address.substr(0, colon);
+            }
+            link = new PeerLink();
+            link->connect(address, port);
+        }
+    }
+    jobs = new JobSystem(threads);
+    if (!replayPath.empty()) {
+        std::exit(playReplay(replayPath));
+    }
+    std::cout << "Simulation tick rate: " << simClock.tickRate << " Hz, "
+              << jobs->threadCount() << " thread(s)\n";
+    
     runOpenGl(argc, argv);
 }
 
@@ -46,7 +144,6 @@ void Game::runOpenGl(int argc, char** argv) {
 
     glutDisplayFunc(display);
     glutIdleFunc(idle);
-    glutTimerFunc(16, timer, 0);
     glutKeyboardFunc(keyPressed);
     glutKeyboardUpFunc(keyUp);
     glutSpecialFunc(specialKeyPressed);
@@ -58,6 +155,9 @@ void Game::runOpenGl(int argc, char** argv) {
 }
 
 void Game::display() {
+    Player* localPlayer = Game::localPlayer();
+    PlayerBody* localBody = Game::localBody();
+    
     glClear(GL_COLOR_BUFFER_BIT);
     glColor3f(1.0f, 1.0f, 1.0f);
 
@@ -101,10 +201,10 @@ void Game::display() {
             drawText(250, yPos, "Players in room:");
             yPos -= 25.0f;
             for (size_t i = 0; i < currentRoom->players.size() && i < 8; i++) {
-                Player* p = currentRoom->players[i];
+                PlayerBody* p = lobby.body(currentRoom->players[i]);
                 if (p != nullptr) {
                     std::string playerText = "  Player " + std::to_string(p->id);
-                    if (p == currentPlayer) {
+                    if (currentRoom->players[i] == currentPlayer) {
                         playerText += " (You)";
                     }
                     drawText(250, yPos, playerText);
@@ -118,36 +218,44 @@ void Game::display() {
             drawText(250, yPos - 40, "ESC - Leave Room");
         }
     }
-    else if (menuState == PLAYING) {
-        if (currentPlayer != nullptr && currentPlayer->isAlive) {
-            cameraX = currentPlayer->x - width / 2.0f;
-            cameraY = currentPlayer->y - height / 2.0f;
+    else if (menuState == PLAYING && currentMatch != nullptr) {
+        SimWorld* world = currentMatch->world;
+        // Blend between the last two simulation ticks
+        float alpha = simClock.alpha();
+        
+        if (localBody != nullptr && localBody->isAlive) {
+            cameraX = lerp(localPlayer->prevX, localBody->x, alpha) - width / 2.0f;
+            cameraY = lerp(localPlayer->prevY, localBody->y, alpha) - height / 2.0f;
         }
         
         glPushMatrix();
         glTranslatef(-cameraX, -cameraY, 0.0f);
         
-        if (gameMap != nullptr) {
-            gameMap->render();
-        }
+        world->gameMap->render();
         
-        for (Bullet* bullet : bullets) {
-            if (bullet != nullptr && bullet->active) {
-                bullet->render();
+        const BulletPool& bullets = world->bullets;
+        for (int i = 0; i < bullets.count; i++) {
+            if (bullets.active[i]) {
+                Bullet::draw(lerp(bullets.prevX[i], bullets.x[i], alpha),
+                             lerp(bullets.prevY[i], bullets.y[i], alpha),
+                             bullets.vx[i], bullets.vy[i], bullets.size);
             }
         }
         
-        for (Player* player : allPlayers) {
-            if (player != nullptr && player->isAlive && player != currentPlayer) {
+        for (int p = 0; p < world->entities.size(); p++) {
+            const PlayerBody* body = &world->entities.bodies[p];
+            const Player* player = &world->entities.players[p];
+            if (body->isAlive && body != localBody) {
                 glPushMatrix();
-                glTranslatef(player->x, player->y, 0.0f);
-                glRotatef(player->angle * 180.0f / 3.14159f, 0.0f, 0.0f, 1.0f);
+                glTranslatef(lerp(player->prevX, body->x, alpha),
+                             lerp(player->prevY, body->y, alpha), 0.0f);
+                player->rotateToAim();
                 
                 glColor3f(1.0f, 0.0f, 0.0f);
                 glBegin(GL_TRIANGLES);
-                glVertex2f(0, player->size / 2);
-                glVertex2f(-player->size / 2, -player->size / 2);
-                glVertex2f(player->size / 2, -player->size / 2);
+                glVertex2f(0, body->size / 2);
+                glVertex2f(-body->size / 2, -body->size / 2);
+                glVertex2f(body->size / 2, -body->size / 2);
                 glEnd();
                 
                 glPopMatrix();
@@ -156,16 +264,16 @@ void Game::display() {
         
         glPopMatrix();
         
-        if (currentPlayer != nullptr && currentPlayer->isAlive) {
+        if (localBody != nullptr && localBody->isAlive) {
             glPushMatrix();
             glTranslatef(width / 2.0f, height / 2.0f, 0.0f);
-            glRotatef(currentPlayer->angle * 180.0f / 3.14159f, 0.0f, 0.0f, 1.0f);
+            localPlayer->rotateToAim();
             
             glColor3f(0.0f, 0.0f, 1.0f);
             glBegin(GL_TRIANGLES);
-            glVertex2f(0, currentPlayer->size / 2);
-            glVertex2f(-currentPlayer->size / 2, -currentPlayer->size / 2);
-            glVertex2f(currentPlayer->size / 2, -currentPlayer->size / 2);
+            glVertex2f(0, localBody->size / 2);
+            glVertex2f(-localBody->size / 2, -localBody->size / 2);
+            glVertex2f(localBody->size / 2, -localBody->size / 2);
             glEnd();
             
             glPopMatrix();
@@ -173,85 +281,132 @@ void Game::display() {
         
         drawCrosshair(mouseX, mouseY);
         
-        int aliveCount = 0;
-        for (Player* p : allPlayers) {
-            if (p != nullptr && p->isAlive) {
-                aliveCount++;
-            }
+        drawText(10, height - 30, "Alive: " + std::to_string(world->aliveCount()));
+        
+        // Kill feed: the last few eliminations, each shown for a few seconds
+        const std::vector<EliminationEvent>& feed = world->eliminations;
+        unsigned int shownTicks = (unsigned int)(KILL_FEED_SECONDS * world->tickRate);
+        float feedY = height - 30.0f;
+        for (int i = (int)feed.size() - 1; i >= 0 && i >= (int)feed.size() - KILL_FEED_LINES; i--) {
+            if (world->tick - feed[i].tick > shownTicks) break;
+            drawText(width - 260.0f, feedY, "Player " + std::to_string(feed[i].killerId) +
+                     " eliminated Player " + std::to_string(feed[i].victimId));
+            feedY -= 20.0f;
         }
-        drawText(10, height - 30, "Alive: " + std::to_string(aliveCount));
     }
-    else if (menuState == MATCH_ENDED) {
-        Player* winner = nullptr;
-        for (Player* p : allPlayers) {
-            if (p != nullptr && p->isAlive) {
-                winner = p;
-                break;
-            }
-        }
+    else if (menuState == MATCH_ENDED && currentMatch != nullptr) {
+        SimWorld* world = currentMatch->world;
+        int winner = world->findPlayer(world->winnerId);
         
-        if (winner != nullptr) {
+        if (winner >= 0) {
             drawText(300, 400, "Match Ended!");
-            if (winner == currentPlayer) {
+            if (&world->entities.bodies[winner] == localBody) {
                 drawText(280, 350, "You Win!");
             } else {
-                drawText(280, 350, "Player " + std::to_string(winner->id) + " Wins!");
+                drawText(280, 350, "Player " + std::to_string(world->winnerId) + " Wins!");
             }
         } else {
             drawText(300, 400, "Match Ended!");
             drawText(280, 350, "No Winner");
         }
         
-        drawText(250, 300, "Press ESC to return to menu");
+        // Scoreboard from the kill counts the eliminations kept
+        float rowY = 300.0f;
+        for (int p = 0; p < world->entities.size(); p++) {
+            if (rowY < 80.0f) break;  // Out of room; large rosters only show the first rows
+            int kills = world->entities.players[p].kills;
+            drawText(280, rowY, "Player " + std::to_string(world->entities.bodies[p].id) + ": " +
+                     std::to_string(kills) + (kills == 1 ? " kill" : " kills"));
+            rowY -= 20.0f;
+        }
+        
+        drawText(250, rowY - 20.0f, "Press ESC to return to menu");
     }
 
     glutSwapBuffers();
 }
 
 void Game::idle() {
+    int now = glutGet(GLUT_ELAPSED_TIME);
+    double frameSeconds = (now - lastFrameTime) / 1000.0;
+    lastFrameTime = now;
+    
+    if (link != nullptr) {
+        link->poll(rollback);
+        if (!link->hosting && link->startReceived && menuState != PLAYING) {
+            joinPeerMatch();
+        }
+    }
+    
     if (menuState == PLAYING) {
+        int ticks = simClock.advance(frameSeconds);
+        for (int i = 0; i < ticks && menuState == PLAYING; i++) {
+            tickSimulation();
+        }
         glutPostRedisplay();
     }
 }
 
-void Game::timer(int value) {
+void Game::tickSimulation() {
     if (menuState == PLAYING) {
-        // Create collision check lambda (gameMap is static, so we can access it directly)
-        auto checkCollision = [](float x, float y, float radius) -> bool {
-            if (Game::gameMap == nullptr) return false;
-            return Game::gameMap->checkCollision(x, y, radius);
-        };
+        std::vector<PlayerInput> inputs;
+        PlayerBody* localBody = Game::localBody();
+        if (localBody != nullptr && localBody->isAlive) {
+            PlayerInput input;
+            input.playerId = localBody->id;
+            input.tick = currentMatch->world->tick;
+            input.buttons = heldKeys | heldArrows | (fireQueued ? InputCmd::FIRE : 0);
+            // The camera follows the player, so the aim is the cursor's offset from the screen center
+            input.setAim(mouseX - width / 2.0f, mouseY - height / 2.0f);
+            inputs.push_back(input);
+        }
+        fireQueued = false;
         
-        for (Player* player : allPlayers) {
-            if (player != nullptr && player->isAlive) {
-                player->updateMovementWithCollision(checkCollision);
+        if (rollback != nullptr) {
+            if (!rollback->canAdvance()) {
+                link->resendInputs();  // Too far ahead of the other player; wait for them
+                return;
+            }
+            // Every tick needs an input from us, even dead, so the peer can confirm it
+            PlayerInput input = inputs.empty() ? PlayerInput() : inputs[0];
+            input.playerId = rollback->localPlayerId;
+            input.tick = currentMatch->world->tick;
+            rollback->addLocalInput(input);
+            link->sendInput(input);
+            rollback->advance();
+            if (rollback->matchDecided()) {
+                currentMatch->end();
+                endRollback();
+                menuState = MATCH_ENDED;
             }
+            return;
         }
         
-        updateBullets();
-        checkBulletCollisions();
-        cleanupBullets();
-        checkWinCondition();
-        
-        glutPostRedisplay();
+        currentMatch->pendingInputs = inputs;
+        currentMatch->update();
+        if (currentMatch->state == Match::ENDED) {
+            currentMatch->printTickTimes();
+            saveRecording();
+            menuState = MATCH_ENDED;
+        }
     }
-    glutTimerFunc(16, timer, 0);
 }
 
 void Game::keyPressed(unsigned char key, int, int) {
     if (menuState == PLAYING) {
-        if (currentPlayer != nullptr && currentPlayer->isAlive) {
-            currentPlayer->handleKey(key, true);
-        }
+        heldKeys |= movementButton(key);
         if (key == 27) {
             menuState = NONE;
             glutSetCursor(GLUT_CURSOR_INHERIT);
-            for (Bullet* bullet : bullets) {
-                if (bullet != nullptr) {
-                    delete bullet;
-                }
+            // Abandoning the match frees its world
+            currentMatch->printTickTimes();
+            if (recording != nullptr) {
+                recording->finish(*currentMatch->world);
             }
-            bullets.clear();
+            saveRecording();
+            endRollback();
+            delete currentMatch;
+            currentMatch = nullptr;
         }
     }
     else if (menuState == MATCH_ENDED) {
@@ -261,21 +416,6 @@ void Game::keyPressed(unsigned char key, int, int) {
                 delete currentMatch;
                 currentMatch = nullptr;
             }
-            for (Player* p : allPlayers) {
-                if (p != nullptr && p != currentPlayer) {
-                    delete p;
-                }
-            }
-            allPlayers.clear();
-            if (currentPlayer != nullptr) {
-                allPlayers.push_back(currentPlayer);
-            }
-            for (Bullet* bullet : bullets) {
-                if (bullet != nullptr) {
-                    delete bullet;
-                }
-            }
-            bullets.clear();
         }
     }
     else if (menuState == IN_ROOM) {
@@ -322,22 +462,22 @@ void Game::keyPressed(unsigned char key, int, int) {
             menuState = ROOM_LIST;
         }
         else if (key == 'c' || key == 'C') {
-            if (currentPlayer == nullptr) {
-                currentPlayer = new Player(1, width/2, height/2);
-                allPlayers.push_back(currentPlayer);
+            if (!lobby.isValid(currentPlayer)) {
+                currentPlayer = lobby.create(PlayerBody(1, width/2, height/2));
             }
             
             Room* newRoom = createRoom("Room " + std::to_string(rooms.size() + 1), 4);
-            if (newRoom != nullptr && currentPlayer != nullptr) {
+            if (newRoom != nullptr) {
                 newRoom->addPlayer(currentPlayer);
                 
-                // Add 2 simple target players for local gameplay (they won't move)
-                Player* target1 = new Player(2, width/2, height/2);
-                Player* target2 = new Player(3, width/2, height/2);
-                newRoom->addPlayer(target1);
-                newRoom->addPlayer(target2);
-                allPlayers.push_back(target1);
-                allPlayers.push_back(target2);
+                if (link != nullptr) {
+                    // The player who joins us plays as player 2
+                    newRoom->addPlayer(lobby.create(PlayerBody(PeerLink::JOIN_PLAYER_ID, width/2, height/2)));
+                } else {
+                    // Add 2 simple target players for local gameplay (they won't move)
+                    newRoom->addPlayer(lobby.create(PlayerBody(2, width/2, height/2)));
+                    newRoom->addPlayer(lobby.create(PlayerBody(3, width/2, height/2)));
+                }
             }
             menuState = IN_ROOM;
             std::cout << "Room created with " << newRoom->getPlayerCount() << " players! Press S to start match.\n";
@@ -351,56 +491,37 @@ void Game::keyPressed(unsigned char key, int, int) {
 }
 
 void Game::keyUp(unsigned char key, int, int) {
-    if (menuState == PLAYING) {
-        if (currentPlayer != nullptr) {
-            currentPlayer->handleKey(key, false);
-        }
-    }
+    heldKeys &= ~movementButton(key);
 }
 
 void Game::specialKeyPressed(int key, int, int) {
     if (menuState == PLAYING) {
-        if (currentPlayer != nullptr && currentPlayer->isAlive) {
-            currentPlayer->handleSpecialKey(key, true);
-        }
+        heldArrows |= arrowButton(key);
         glutPostRedisplay();
     }
 }
 
 void Game::specialKeyUp(int key, int, int) {
-    if (menuState == PLAYING) {
-        if (currentPlayer != nullptr) {
-            currentPlayer->handleSpecialKey(key, false);
-        }
-    }
+    heldArrows &= ~arrowButton(key);
 }
 
 void Game::mouseMotion(int x, int y) {
     mouseX = x;
     mouseY = height - y;
     
+    // Aim is sent to the simulation with the next tick input
     if (menuState == PLAYING) {
-        if (currentPlayer != nullptr && currentPlayer->isAlive) {
-            float worldMouseX = currentPlayer->x + (mouseX - width / 2.0f);
-            float worldMouseY = currentPlayer->y + (mouseY - height / 2.0f);
-            currentPlayer->updateAim(worldMouseX, worldMouseY);
-            glutPostRedisplay();
-        }
+        glutPostRedisplay();
     }
 }
 
 void Game::mouseClick(int button, int state, int x, int y) {
     if (menuState == PLAYING && button == GLUT_LEFT_BUTTON && state == GLUT_DOWN) {
-        if (currentPlayer != nullptr && currentPlayer->isAlive) {
-            float screenMouseX = x;
-            float screenMouseY = height - y;
-            float worldMouseX = currentPlayer->x + (screenMouseX - width / 2.0f);
-            float worldMouseY = currentPlayer->y + (screenMouseY - height / 2.0f);
-            
-            float spawnX, spawnY;
-            currentPlayer->getBulletSpawnPosition(spawnX, spawnY);
-            Bullet* newBullet = new Bullet(spawnX, spawnY, currentPlayer->angle, currentPlayer->id);
-            bullets.push_back(newBullet);
+        PlayerBody* localBody = Game::localBody();
+        if (localBody != nullptr && localBody->isAlive) {
+            mouseX = x;
+            mouseY = height - y;
+            fireQueued = true;
             
             Sound::playGunshot();
             glutPostRedisplay();
@@ -437,87 +558,51 @@ void Game::drawCrosshair(float x, float y) {
     glLineWidth(1.0f);
 }
 
-void Game::updateBullets() {
-    for (Bullet* bullet : bullets) {
-        if (bullet != nullptr && bullet->active) {
-            // Store old position
-            float oldX = bullet->x;
-            float oldY = bullet->y;
-            
-            // Update bullet position
-            bullet->update();
-            
-            // Check collision with map obstacles
-            if (gameMap != nullptr && gameMap->checkCollision(bullet->x, bullet->y, bullet->size)) {
-                bullet->active = false;
-                bullet->x = oldX;  // Revert position
-                bullet->y = oldY;
-            }
-            
-            // Check bounds
-            if (bullet->isOutOfBounds(width, height)) {
-                bullet->active = false;
-            }
-        }
+Player* Game::localPlayer() {
+    if (currentMatch != nullptr) {
+        return currentMatch->world->getPlayer(currentMatch->worldHandle(currentPlayer));
     }
+    return lobby.get(currentPlayer);
 }
 
-void Game::checkBulletCollisions() {
-    for (Bullet* bullet : bullets) {
-        if (bullet == nullptr || !bullet->active) continue;
-        
-        for (Player* player : allPlayers) {
-            if (player == nullptr || !player->isAlive) continue;
-            if (player->id == bullet->ownerId) continue;
-            
-            float dx = bullet->x - player->x;
-            float dy = bullet->y - player->y;
-            float distance = sqrt(dx * dx + dy * dy);
-            
-            if (distance < player->size / 2.0f + bullet->size) {
-                player->eliminate();
-                bullet->active = false;
-                std::cout << "Player " << player->id << " eliminated by Player " << bullet->ownerId << "!\n";
-                break;
-            }
-        }
+PlayerBody* Game::localBody() {
+    if (currentMatch != nullptr) {
+        return currentMatch->world->getBody(currentMatch->worldHandle(currentPlayer));
     }
+    return lobby.body(currentPlayer);
 }
 
-void Game::checkWinCondition() {
-    if (menuState != PLAYING) return;
-    
-    int aliveCount = 0;
-    Player* lastAlive = nullptr;
-    
-    for (Player* player : allPlayers) {
-        if (player != nullptr && player->isAlive) {
-            aliveCount++;
-            lastAlive = player;
-        }
-    }
-    
-    if (aliveCount <= 1 && allPlayers.size() > 1) {
-        menuState = MATCH_ENDED;
-        std::cout << "Match ended! ";
-        if (lastAlive != nullptr) {
-            std::cout << "Player " << lastAlive->id << " wins!\n";
-        }
+void Game::saveRecording() {
+    if (recording != nullptr && recording->save(recordPath)) {
+        std::cout << "Replay saved to " << recordPath << " (" << recording->tickCount << " ticks, "
+                  << recording->data.size() << " bytes of input)\n";
     }
 }
 
-void Game::cleanupBullets() {
-    bullets.erase(
-        std::remove_if(bullets.begin(), bullets.end(),
-            [](Bullet* bullet) {
-                if (bullet != nullptr && !bullet->active) {
-                    delete bullet;
-                    return true;
-                }
-                return false;
-            }),
-        bullets.end()
-    );
+int Game::playReplay(const std::string& path) {
+    Replay replay;
+    if (!replay.load(path)) {
+        return 1;
+    }
+
+    ReplayPlayer player(replay, jobs);
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);  // Silence the match's own messages
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    player.runToEnd();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout.rdbuf(coutBuffer);
+
+    std::cout << "Replayed " << replay.tickCount << " ticks (" << (double)replay.tickCount / replay.tickRate
+              << " s of play) in " << ms << " ms\n";
+    if (player.world->matchOver) {
+        std::cout << "Winner: player " << player.world->winnerId << "\n";
+    }
+    if (!player.matchesRecording()) {
+        std::cout << "Final state differs from the recording\n";
+        return 2;
+    }
+    std::cout << "Final state matches the recording\n";
+    return 0;
 }
 
 Room* Game::createRoom(const std::string& roomName, int maxPlayers) {
@@ -531,9 +616,8 @@ Room* Game::createRoom(const std::string& roomName, int maxPlayers) {
 bool Game::joinRoom(int roomId) {
     for (Room* room : rooms) {
         if (room->roomId == roomId && room->canJoin()) {
-            if (currentPlayer == nullptr) {
-                currentPlayer = new Player(1, width/2, height/2);
-                allPlayers.push_back(currentPlayer);
+            if (!lobby.isValid(currentPlayer)) {
+                currentPlayer = lobby.create(PlayerBody(1, width/2, height/2));
             }
             if (room->addPlayer(currentPlayer)) {
                 currentRoom = room;
@@ -555,104 +639,96 @@ void Game::startMatch() {
         return;
     }
     
-    if (gameMap == nullptr) {
-        gameMap = new Map(width, height);
-    }
-    
-    if (currentPlayer == nullptr) {
+    if (!lobby.isValid(currentPlayer)) {
         if (!currentRoom->players.empty()) {
             currentPlayer = currentRoom->players[0];
         } else {
-            currentPlayer = new Player(1, width/2, height/2);
+            currentPlayer = lobby.create(PlayerBody(1, width/2, height/2));
             currentRoom->addPlayer(currentPlayer);
         }
     }
     
-    allPlayers.clear();
-    for (Player* p : currentRoom->players) {
-        if (p != nullptr) {
-            p->isAlive = true;
-            allPlayers.push_back(p);
-        }
-    }
-    
-    // Spawn players in valid positions (avoiding obstacles)
-    float spawnRadius = std::min(width, height) * 0.35f;
-    float centerX = width / 2.0f;
-    float centerY = height / 2.0f;
-    float playerRadius = 15.0f;  // Player collision radius
-    
-    for (size_t i = 0; i < allPlayers.size(); i++) {
-        Player* p = allPlayers[i];
-        if (p != nullptr) {
-            // Try to find a valid spawn position
-            bool foundValidPosition = false;
-            int attempts = 0;
-            float angle = (2.0f * 3.14159f * i) / allPlayers.size();
-            
-            // Try multiple angles around the circle
-            for (int attempt = 0; attempt < 20 && !foundValidPosition; attempt++) {
-                float testAngle = angle + (attempt * 0.1f);
-                float testX = centerX + cos(testAngle) * spawnRadius;
-                float testY = centerY + sin(testAngle) * spawnRadius;
-                
-                // Try different radii if needed
-                for (float radiusMult = 1.0f; radiusMult >= 0.5f && !foundValidPosition; radiusMult -= 0.1f) {
-                    float testX2 = centerX + cos(testAngle) * spawnRadius * radiusMult;
-                    float testY2 = centerY + sin(testAngle) * spawnRadius * radiusMult;
-                    
-                    if (gameMap->isValidSpawnPosition(testX2, testY2, playerRadius)) {
-                        p->x = testX2;
-                        p->y = testY2;
-                        foundValidPosition = true;
-                        break;
-                    }
-                }
-            }
-            
-            // Fallback: spawn at corners if circle positions fail
-            if (!foundValidPosition) {
-                float corners[4][2] = {
-                    {width * 0.15f, height * 0.15f},
-                    {width * 0.85f, height * 0.15f},
-                    {width * 0.15f, height * 0.85f},
-                    {width * 0.85f, height * 0.85f}
-                };
-                int cornerIndex = i % 4;
-                p->x = corners[cornerIndex][0];
-                p->y = corners[cornerIndex][1];
-                
-                // If corner also fails, just use a safe default
-                if (!gameMap->isValidSpawnPosition(p->x, p->y, playerRadius)) {
-                    p->x = width * 0.1f + (i * 50.0f);
-                    p->y = height * 0.1f + (i * 50.0f);
-                }
-            }
+    // A linked match needs the other player connected; the joining side takes the host's settings
+    unsigned int seed = (unsigned int)std::time(nullptr);
+    if (link != nullptr) {
+        if (!link->isConnected()) {
+            std::cout << "Cannot start match: the other player is not connected\n";
+            return;
+        }
+        if (link->hosting) {
+            link->sendStart(seed, simClock.tickRate, deterministic);
+        } else {
+            seed = link->startSeed;
+            simClock.setTickRate(link->startTickRate);
+            deterministic = link->startDeterministic;
         }
+        link->resetInputs();
     }
     
+    // The match copies the room's roster into a world of its own
     currentRoom->setStatus(Room::STARTING);
     int matchId = currentRoom->roomId;
-    currentMatch = new Match(matchId, currentRoom);
-    currentMatch->gameMap = gameMap;
+    currentMatch = new Match(matchId, currentRoom, lobby, width, height);
+    currentMatch->world->setTickRate(simClock.tickRate);
+    currentMatch->world->jobs = jobs;
+    currentMatch->world->setDeterministic(deterministic);
+    currentMatch->world->seed = seed;
+    if (!recordPath.empty() && link == nullptr) {
+        if (recording == nullptr) {
+            recording = new Replay();
+        }
+        currentMatch->recording = recording;
+    }
     currentMatch->start();
     currentRoom->setStatus(Room::IN_MATCH);
     
-    mouseX = width / 2.0f;
-    mouseY = height / 2.0f;
-    
-    for (Bullet* bullet : bullets) {
-        if (bullet != nullptr) {
-            delete bullet;
+    if (link != nullptr) {
+        std::vector<int> roster;
+        for (const PlayerBody& body : currentMatch->world->entities.bodies) {
+            roster.push_back(body.id);
         }
+        rollback = new RollbackSession(currentMatch->world, localBody()->id, roster);
     }
-    bullets.clear();
+    
+    mouseX = width / 2.0f;
+    mouseY = height / 2.0f;
+    fireQueued = false;
+    simClock.reset();
+    lastFrameTime = glutGet(GLUT_ELAPSED_TIME);
     
     glutSetCursor(GLUT_CURSOR_NONE);
     
     std::cout << "Match started! Room " << currentRoom->roomId << " with " << currentRoom->getPlayerCount() << " players\n";
 }
 
+void Game::joinPeerMatch() {
+    // Same roster as the host's room: host is player 1, we are player 2
+    currentPlayer = lobby.create(PlayerBody(PeerLink::JOIN_PLAYER_ID, width/2, height/2));
+    Room* room = createRoom("LAN match", 2);
+    room->addPlayer(lobby.create(PlayerBody(PeerLink::HOST_PLAYER_ID, width/2, height/2)));
+    room->addPlayer(currentPlayer);
+    
+    if (currentMatch != nullptr) {
+        endRollback();
+        delete currentMatch;
+        currentMatch = nullptr;
+    }
+    startMatch();
+    if (currentMatch != nullptr && currentMatch->isActive()) {
+        menuState = PLAYING;
+    }
+}
+
+void Game::endRollback() {
+    if (rollback != nullptr) {
+        std::cout << "Rollbacks: " << rollback->rollbacks << " (" << rollback->resimulatedTicks
+                  << " ticks re-simulated, max " << rollback->maxRollbackMs << " ms), "
+                  << rollback->lateInputs << " late inputs\n";
+        delete rollback;
+        rollback = nullptr;
+    }
+}
+
 void Game::requestRoomList() {
     // Room list is just the local rooms vector
 }
@@ -0,0 +1,114 @@
+#include "JobSystem.h"
+
+JobSystem::JobSystem(int threadCount) : pending(0), stopping(false) {
+    if (threadCount < 1) threadCount = 1;
+    for (int i = 0; i < threadCount; i++) {
+        queues.push_back(new Queue());
+    }
+    for (int i = 1; i < threadCount; i++) {
+        workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    for (Queue* queue : queues) {
+        delete queue;
+    }
+}
+
+void JobSystem::parallelFor(int count, int chunkSize, const RangeJob& job) {
+    if (count <= 0) return;
+    if (chunkSize < 1) chunkSize = 1;
+
+    int threads = threadCount();
+    if (threads == 1 || count <= chunkSize) {
+        job(0, count);
+        return;
+    }
+
+    // Deal the chunks out round-robin; idle threads steal to even out the load
+    int chunks = (count + chunkSize - 1) / chunkSize;
+    std::atomic<int> remaining(chunks);
+    for (int c = 0; c < chunks; c++) {
+        Chunk chunk;
+        chunk.job = &job;
+        chunk.begin = c * chunkSize;
+        chunk.end = (chunk.begin + chunkSize < count) ? chunk.begin + chunkSize : count;
+        chunk.remaining = &remaining;
+
+        Queue* queue = queues[c % threads];
+        std::lock_guard<std::mutex> guard(queue->lock);
+        queue->chunks.push_back(chunk);
+    }
+    pending += chunks;
+    {
+        // Taking the lock orders this wake-up after any worker's check of pending
+        std::lock_guard<std::mutex> guard(sleepLock);
+    }
+    wake.notify_all();
+
+    // Help out until every chunk has finished, including ones other threads took
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        Chunk chunk;
+        if (take(0, chunk)) {
+            run(chunk);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool JobSystem::popOwn(int queue, Chunk& out) {
+    Queue* own = queues[queue];
+    std::lock_guard<std::mutex> guard(own->lock);
+    if (own->chunks.empty()) return false;
+    out = own->chunks.back();
+    own->chunks.pop_back();
+    pending--;
+    return true;
+}
+
+bool JobSystem::steal(int thief, Chunk& out) {
+    int threads = threadCount();
+    for (int k = 1; k < threads; k++) {
+        Queue* victim = queues[(thief + k) % threads];
+        std::lock_guard<std::mutex> guard(victim->lock);
+        if (victim->chunks.empty()) continue;
+        out = victim->chunks.front();
+        victim->chunks.pop_front();
+        pending--;
+        return true;
+    }
+    return false;
+}
+
+bool JobSystem::take(int queue, Chunk& out) {
+    return popOwn(queue, out) || steal(queue, out);
+}
+
+void JobSystem::run(const Chunk& chunk) {
+    (*chunk.job)(chunk.begin, chunk.end);
+    chunk.remaining->fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::workerLoop(int queue) {
+    for (;;) {
+        Chunk chunk;
+        if (take(queue, chunk)) {
+            run(chunk);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wake.wait(guard, [this]() { return stopping || pending.load() > 0; });
+        if (stopping && pending.load() == 0) return;
+    }
+}
@@ -1,6 +1,60 @@
 #include "Map.h"
+#ifndef OJ_HEADLESS
 #include <GL/freeglut.h>
+#endif
 #include <cmath>
+#include <algorithm>
+#include <mutex>
+#ifdef OJ_VALIDATE_COLLISION
+#include <iostream>
+#endif
+
+Obstacle::Obstacle(float centerX, float centerY, float width, float height, float angle)
+    : centerX(centerX), centerY(centerY), halfWidth(width / 2.0f), halfHeight(height / 2.0f),
+      angle(angle) {
+    float radians = angle * 3.14159265f / 180.0f;
+    cosAngle = cos(radians);
+    sinAngle = sin(radians);
+    
+    int fixedAngle = angleFromDegrees(angle);
+    fixedCenterX = toFixed(centerX);
+    fixedCenterY = toFixed(centerY);
+    fixedHalfWidth = toFixed(halfWidth);
+    fixedHalfHeight = toFixed(halfHeight);
+    fixedCosAngle = fixedCos(fixedAngle);
+    fixedSinAngle = fixedSin(fixedAngle);
+}
+
+float Obstacle::signedDistance(float x, float y) const {
+    // Rotate the point into the rectangle's frame, then use the box distance
+    float dx = x - centerX;
+    float dy = y - centerY;
+    float localX = std::fabs(dx * cosAngle + dy * sinAngle) - halfWidth;
+    float localY = std::fabs(-dx * sinAngle + dy * cosAngle) - halfHeight;
+    
+    float outsideX = std::max(localX, 0.0f);
+    float outsideY = std::max(localY, 0.0f);
+    float outside = sqrt(outsideX * outsideX + outsideY * outsideY);
+    float inside = std::min(std::max(localX, localY), 0.0f);
+    return outside + inside;
+}
+
+Fixed Obstacle::signedDistanceFixed(Fixed x, Fixed y) const {
+    Fixed dx = x - fixedCenterX;
+    Fixed dy = y - fixedCenterY;
+    Fixed localX = std::abs(fixedMul(dx, fixedCosAngle) + fixedMul(dy, fixedSinAngle)) - fixedHalfWidth;
+    Fixed localY = std::abs(fixedMul(dy, fixedCosAngle) - fixedMul(dx, fixedSinAngle)) - fixedHalfHeight;
+    
+    Fixed outside = fixedLength(std::max(localX, 0), std::max(localY, 0));
+    Fixed inside = std::min(std::max(localX, localY), 0);
+    return outside + inside;
+}
+
+Rect Obstacle::bounds() const {
+    float extentX = std::fabs(cosAngle) * halfWidth + std::fabs(sinAngle) * halfHeight;
+    float extentY = std::fabs(sinAngle) * halfWidth + std::fabs(cosAngle) * halfHeight;
+    return Rect(centerX - extentX, centerX + extentX, centerY + extentY, centerY - extentY);
+}
 
 Map::Map(float w, float h) {
     width = w;
@@ -8,39 +62,64 @@ Map::Map(float w, float h) {
     initializeMap();
 }
 
+const Map* Map::shared(float w, float h) {
+    // Few layouts ever exist, so a list beats a map; entries are never freed
+    // because worlds hold plain pointers into them
+    static std::mutex lock;
+    static std::vector<const Map*> baked;
+    
+    std::lock_guard<std::mutex> guard(lock);
+    for (const Map* map : baked) {
+        if (map->width == w && map->height == h) return map;
+    }
+    baked.push_back(new Map(w, h));
+    return baked.back();
+}
+
 void Map::initializeMap() {
-    collisionRects.clear();
+    obstacles.clear();
     
-    // Add collision rectangles for borders
+    // Add collision shapes for borders
     float borderSize = 20.0f;
-    collisionRects.push_back(Rect(0, borderSize, height, 0));  // Left wall
-    collisionRects.push_back(Rect(width - borderSize, width, height, 0));  // Right wall
-    collisionRects.push_back(Rect(0, width, borderSize, 0));  // Bottom wall
-    collisionRects.push_back(Rect(0, width, height, height - borderSize));  // Top wall
+    obstacles.push_back(Obstacle(borderSize / 2.0f, height / 2.0f, borderSize, height));  // Left wall
+    obstacles.push_back(Obstacle(width - borderSize / 2.0f, height / 2.0f, borderSize, height));  // Right wall
+    obstacles.push_back(Obstacle(width / 2.0f, borderSize / 2.0f, width, borderSize));  // Bottom wall
+    obstacles.push_back(Obstacle(width / 2.0f, height - borderSize / 2.0f, width, borderSize));  // Top wall
     
-    // Add collision rectangles for obstacles
+    // Add collision shapes for obstacles
     // IMPORTANT: These must match the obstacles you draw in render()!
-    // For each obstacle in render(), add a corresponding collision rect here
+    // Use the same center, size and rotation as the glTranslatef/glScalef/glRotatef calls
     
     // Obstacle 1: Center at (150, 125), Size 100x50
-    collisionRects.push_back(Rect(100, 200, 150, 100));
+    obstacles.push_back(Obstacle(150, 125, 100, 50));
     
     // Obstacle 2: Center at (350, 175), Size 100x50, Rotated 45 degrees
-    // For rotated rectangles, use a bounding box that covers the rotation
-    float rotSize = 100.0f * 1.414f;  // Diagonal of 100x50 rectangle
-    collisionRects.push_back(Rect(350 - rotSize/2, 350 + rotSize/2, 175 + rotSize/2, 175 - rotSize/2));
+    obstacles.push_back(Obstacle(350, 175, 100, 50, 45.0f));
     
     // Obstacle 3: Center at (550, 225), Size 100x50
-    collisionRects.push_back(Rect(500, 600, 250, 200));
+    obstacles.push_back(Obstacle(550, 225, 100, 50));
     
     // Obstacle 4: Center at (250, 375), Size 80x80, Rotated 30 degrees
-    float rotSize2 = 80.0f * 1.414f;
-    collisionRects.push_back(Rect(250 - rotSize2/2, 250 + rotSize2/2, 375 + rotSize2/2, 375 - rotSize2/2));
+    obstacles.push_back(Obstacle(250, 375, 80, 80, 30.0f));
     
     // Obstacle 5: Center at (500, 425), Size 120x40
-    collisionRects.push_back(Rect(440, 560, 445, 405));
+    obstacles.push_back(Obstacle(500, 425, 120, 40));
+    
+    // Obstacles never change after this point, so the tree, field and spawn points are built once per map
+    buildCollisionData();
+}
+
+void Map::buildCollisionData() {
+    collisionRects.clear();
+    for (const Obstacle& obstacle : obstacles) {
+        collisionRects.push_back(obstacle.bounds());
+    }
+    collisionTree.build(collisionRects);
+    distanceField.build(obstacles, collisionRects, collisionTree, 0.0f, 0.0f, width, height, (float)FIELD_CELL_SIZE);
+    spawnPoints.build(*this, (float)SPAWN_SPACING, (float)SPAWN_RADIUS);
 }
 
+#ifndef OJ_HEADLESS
 // Helper function to draw a unit square (centered at origin, size 1x1)
 void drawUnitSquare() {
     glBegin(GL_QUADS);
@@ -51,7 +130,7 @@ void drawUnitSquare() {
     glEnd();
 }
 
-void Map::render() {
+void Map::render() const {
     // Draw background
     glColor3f(0.2f, 0.2f, 0.2f);
     glBegin(GL_QUADS);
@@ -147,16 +226,212 @@ void Map::render() {
     // ADD MORE OBSTACLES HERE USING TRANSFORMATIONS
     // ============================================
 }
+#endif
+
+float Map::distanceAt(float x, float y) const {
+    if (distanceField.covers(x, y)) {
+        return distanceField.sample(x, y);
+    }
+    return distanceLinear(x, y);
+}
+
+float Map::distanceLinear(float x, float y) const {
+    float distance = 1e30f;
+    for (const Obstacle& obstacle : obstacles) {
+        distance = std::min(distance, obstacle.signedDistance(x, y));
+    }
+    return distance;
+}
+
+bool Map::normalAt(float x, float y, float& outX, float& outY) const {
+    float gx, gy;
+    distanceField.gradient(x, y, gx, gy);
+    float length = sqrt(gx * gx + gy * gy);
+    if (length < 1e-6f) return false;
+    outX = gx / length;
+    outY = gy / length;
+    return true;
+}
+
+bool Map::overlapsExact(float x, float y, float radius) const {
+    static thread_local std::vector<int> candidates;
+    candidates.clear();
+    collisionTree.queryBox(collisionRects, x - radius, y - radius, x + radius, y + radius, candidates);
+    for (int index : candidates) {
+        if (obstacles[index].signedDistance(x, y) < radius) {
+            return true;
+        }
+    }
+    return false;
+}
 
 bool Map::checkCollision(float x, float y, float radius) const {
-    for (const Rect& rect : collisionRects) {
-        if (rect.checkCircleCollision(x, y, radius)) {
+    if (!distanceField.covers(x, y)) {
+        return overlapsExact(x, y, radius);
+    }
+    
+    float distance = distanceField.sample(x, y);
+    bool hit = distance < radius;
+#ifdef OJ_VALIDATE_COLLISION
+    // Build with -DOJ_VALIDATE_COLLISION to cross-check the field against the
+    // exact shapes. Answers within a cell of the surface may differ.
+    float exact = distanceLinear(x, y);
+    if (hit != (exact < radius) && std::fabs(exact - radius) > (float)FIELD_CELL_SIZE) {
+        std::cerr << "Map::checkCollision mismatch at (" << x << ", " << y << ") r=" << radius
+                  << " field=" << distance << " exact=" << exact << "\n";
+    }
+#endif
+    return hit;
+}
+
+bool Map::checkCollisionLinear(float x, float y, float radius) const {
+    for (const Obstacle& obstacle : obstacles) {
+        if (obstacle.signedDistance(x, y) < radius) {
             return true;
         }
     }
     return false;
 }
 
+bool Map::containsPoint(float x, float y) const {
+    return checkCollision(x, y, 0.0f);
+}
+
+void Map::checkCollisionBatch(const float* xs, const float* ys, int count, float radius,
+                              std::vector<unsigned int>& hitMask) const {
+    static thread_local std::vector<float> distances;
+    hitMask.assign((count + 31) / 32, 0u);
+    distances.resize(count);
+    distanceField.sampleBatch(xs, ys, count, distances.data());
+    
+    for (int i = 0; i < count; i++) {
+        bool hit = distanceField.covers(xs[i], ys[i]) ? distances[i] < radius : overlapsExact(xs[i], ys[i], radius);
+        if (hit) {
+            hitMask[i / 32] |= 1u << (i % 32);
+        }
+    }
+}
+
+float Map::castCircle(float x, float y, float radius, float dirX, float dirY, float maxDistance) const {
+    const float contact = 0.01f;    // Gap treated as touching
+    const float minStep = 1.0f;     // Progress made while grazing a wall
+    
+    // Sphere tracing: the field distance is always a safe step. A forced
+    // minStep may end inside a wall, so the contact is then bisected.
+    float traveled = 0.0f;
+    float gap = distanceAt(x, y) - radius;
+    if (gap <= contact) return 0.0f;
+    while (traveled < maxDistance) {
+        float next = traveled + std::max(gap, minStep);
+        gap = distanceAt(x + dirX * next, y + dirY * next) - radius;
+        if (gap <= contact) {
+            for (int i = 0; i < 8; i++) {
+                float middle = 0.5f * (traveled + next);
+                if (distanceAt(x + dirX * middle, y + dirY * middle) - radius <= contact) next = middle;
+                else traveled = middle;
+            }
+            return std::min(next, maxDistance);
+        }
+        traveled = next;
+    }
+    return maxDistance;
+}
+
+bool Map::sweepCircle(float x, float y, float radius, float dx, float dy, SweepHit& hit) const {
+    return traceCircle(x, y, radius, dx, dy, distanceAt(x, y) - radius, false, hit);
+}
+
+bool Map::traceCircle(float x, float y, float radius, float dx, float dy, float gap, bool sliding,
+                      SweepHit& hit) const {
+    const int maxSteps = 64;
+    const float contact = 0.01f;                        // Gap treated as touching
+    const float safe = 0.7071f;                         // The bilinear field changes up to sqrt(2) per unit
+    const float maxGraze = std::max(radius * 0.5f, 0.5f);  // Longest step while grazing, so it can't tunnel
+    
+    hit = SweepHit();
+    float length = sqrt(dx * dx + dy * dy);
+    if (length == 0.0f) return false;
+    
+    // Sphere tracing: a step of the field distance can't reach a wall, so in
+    // the open the first sample clears the whole move. While grazing a wall
+    // it steps up to half a radius and bisects back if that goes in deeper
+    // than the circle started; a wall it had to bisect back from is a hit
+    // even where the normal says grazing (a concave corner).
+    float t = 0.0f;
+    const float deepest = std::min(gap, 0.0f);
+    bool bisected = false;
+    for (int step = 0; step < maxSteps; step++) {
+        bool forced = gap <= contact;
+        if (forced && (step > 0 || !sliding)) {
+            float nx, ny;
+            bool hasNormal = normalAt(x + dx * t, y + dy * t, nx, ny);
+            // Moving away from or along the surface is never blocked
+            if (bisected || (hasNormal && dx * nx + dy * ny < 0.0f)) {
+                if (!hasNormal) {
+                    nx = -dx / length;
+                    ny = -dy / length;
+                }
+                hit.hit = true;
+                hit.time = t;
+                hit.normalX = nx;
+                hit.normalY = ny;
+                hit.gap = gap;
+                return true;
+            }
+        }
+        if (t >= 1.0f) return false;
+        float next = t + (forced ? maxGraze : gap * safe) / length;
+        if (next >= 1.0f && !forced) return false;
+        next = std::min(next, 1.0f);
+        
+        float nextGap = distanceAt(x + dx * next, y + dy * next) - radius;
+        if (nextGap < deepest) {
+            for (int i = 0; i < 8; i++) {
+                float middle = 0.5f * (t + next);
+                float middleGap = distanceAt(x + dx * middle, y + dy * middle) - radius;
+                if (middleGap < deepest) {
+                    next = middle;
+                } else {
+                    t = middle;
+                    gap = middleGap;
+                }
+            }
+            bisected = true;
+            continue;   // t is at the surface, just outside it
+        }
+        if (next >= 1.0f) return false;
+        t = next;
+        gap = nextGap;
+    }
+    return false;
+}
+
+void Map::moveCircle(float& x, float& y, float radius, float dx, float dy) const {
+    // Sweep, then slide what is left of the move along the wall that stopped
+    // it and sweep again. In the open that is one query. A second wall right
+    // away, or a third one, is a corner and stops the circle. The sweep never
+    // ends deeper in a wall than it started, so there is nothing to push out.
+    SweepHit hit;
+    for (int pass = 0; pass < 3; pass++) {
+        bool hitWall = pass == 0 ? sweepCircle(x, y, radius, dx, dy, hit)
+                                 : traceCircle(x, y, radius, dx, dy, hit.gap, true, hit);
+        if (!hitWall) {
+            x += dx;
+            y += dy;
+            return;
+        }
+        if (pass > 0 && hit.time == 0.0f) return;
+        x += dx * hit.time;
+        y += dy * hit.time;
+        float rest = 1.0f - hit.time;
+        dx *= rest;
+        dy *= rest;
+        float into = dx * hit.normalX + dy * hit.normalY;
+        dx -= into * hit.normalX;
+        dy -= into * hit.normalY;
+    }
+}
+
 bool Map::isValidSpawnPosition(float x, float y, float radius) const {
     // Check bounds
     float margin = radius + 10.0f;
@@ -167,3 +442,150 @@ bool Map::isValidSpawnPosition(float x, float y, float radius) const {
     // Check collision
     return !checkCollision(x, y, radius);
 }
+
+Fixed Map::distanceAtFixed(Fixed x, Fixed y) const {
+    if (distanceField.coversFixed(x, y)) {
+        return distanceField.sampleFixed(x, y);
+    }
+    Fixed distance = 0x7FFFFFFF;
+    for (const Obstacle& obstacle : obstacles) {
+        distance = std::min(distance, obstacle.signedDistanceFixed(x, y));
+    }
+    return distance;
+}
+
+bool Map::normalAtFixed(Fixed x, Fixed y, Fixed& outX, Fixed& outY) const {
+    Fixed gx, gy;
+    distanceField.gradientFixed(x, y, gx, gy);
+    Fixed length = fixedLength(gx, gy);
+    if (length < 16) return false;  // Flat field (about 0.0002 units per unit)
+    outX = fixedDiv(gx, length);
+    outY = fixedDiv(gy, length);
+    return true;
+}
+
+bool Map::checkCollisionFixed(Fixed x, Fixed y, Fixed radius) const {
+    return distanceAtFixed(x, y) < radius;
+}
+
+bool Map::sweepCircleFixed(Fixed x, Fixed y, Fixed radius, Fixed dx, Fixed dy, SweepHit& hit) const {
+    return traceCircleFixed(x, y, radius, dx, dy, distanceAtFixed(x, y) - radius, false, hit);
+}
+
+bool Map::traceCircleFixed(Fixed x, Fixed y, Fixed radius, Fixed dx, Fixed dy, Fixed gap, bool sliding,
+                           SweepHit& hit) const {
+    // Same trace as traceCircle(), with t a 16.16 fraction of the move
+    const int maxSteps = 64;
+    const Fixed contact = 655;                          // About 0.01 units
+    const Fixed safe = 46341;                           // 1 / sqrt(2)
+    const Fixed maxGraze = std::max(radius / 2, FIXED_ONE / 2);
+    
+    hit = SweepHit();
+    Fixed length = fixedLength(dx, dy);
+    if (length == 0) return false;
+    
+    Fixed t = 0;
+    const Fixed deepest = std::min(gap, (Fixed)0);
+    bool bisected = false;
+    for (int step = 0; step < maxSteps; step++) {
+        bool forced = gap <= contact;
+        if (forced && (step > 0 || !sliding)) {
+            Fixed nx, ny;
+            bool hasNormal = normalAtFixed(x + fixedMul(dx, t), y + fixedMul(dy, t), nx, ny);
+            if (bisected || (hasNormal && fixedMul(dx, nx) + fixedMul(dy, ny) < 0)) {
+                if (!hasNormal) {
+                    nx = -fixedDiv(dx, length);
+                    ny = -fixedDiv(dy, length);
+                }
+                hit.hit = true;
+                hit.fixedTime = t;
+                hit.fixedNormalX = nx;
+                hit.fixedNormalY = ny;
+                hit.fixedGap = gap;
+                return true;
+            }
+        }
+        if (t >= FIXED_ONE) return false;
+        Fixed advance = forced ? maxGraze : fixedMul(gap, safe);
+        Fixed next = advance >= length ? FIXED_ONE : std::min(t + fixedDiv(advance, length), FIXED_ONE);
+        if (next >= FIXED_ONE && !forced) return false;
+        
+        Fixed nextGap = distanceAtFixed(x + fixedMul(dx, next), y + fixedMul(dy, next)) - radius;
+        if (nextGap < deepest) {
+            for (int i = 0; i < 8; i++) {
+                Fixed middle = t + (next - t) / 2;
+                Fixed middleGap = distanceAtFixed(x + fixedMul(dx, middle), y + fixedMul(dy, middle)) - radius;
+                if (middleGap < deepest) {
+                    next = middle;
+                } else {
+                    t = middle;
+                    gap = middleGap;
+                }
+            }
+            bisected = true;
+            continue;
+        }
+        if (next >= FIXED_ONE) return false;
+        t = next;
+        gap = nextGap;
+    }
+    return false;
+}
+
+void Map::moveCircleFixed(Fixed& x, Fixed& y, Fixed radius, Fixed dx, Fixed dy) const {
+    // Same sweep-and-slide as moveCircle()
+    SweepHit hit;
+    for (int pass = 0; pass < 3; pass++) {
+        bool hitWall = pass == 0 ? sweepCircleFixed(x, y, radius, dx, dy, hit)
+                                 : traceCircleFixed(x, y, radius, dx, dy, hit.fixedGap, true, hit);
+        if (!hitWall) {
+            x += dx;
+            y += dy;
+            return;
+        }
+        if (pass > 0 && hit.fixedTime == 0) return;
+        x += fixedMul(dx, hit.fixedTime);
+        y += fixedMul(dy, hit.fixedTime);
+        Fixed rest = FIXED_ONE - hit.fixedTime;
+        dx = fixedMul(dx, rest);
+        dy = fixedMul(dy, rest);
+        Fixed into = fixedMul(dx, hit.fixedNormalX) + fixedMul(dy, hit.fixedNormalY);
+        dx -= fixedMul(into, hit.fixedNormalX);
+        dy -= fixedMul(into, hit.fixedNormalY);
+    }
+}
+
+bool Map::isValidSpawnPositionFixed(Fixed x, Fixed y, Fixed radius) const {
+    Fixed margin = radius + 10 * FIXED_ONE;
+    if (x < margin || x > toFixed(width) - margin || y < margin || y > toFixed(height) - margin) {
+        return false;
+    }
+    return !checkCollisionFixed(x, y, radius);
+}
+
+Fixed Map::castCircleFixed(Fixed x, Fixed y, Fixed radius, Fixed dirX, Fixed dirY, Fixed maxDistance) const {
+    // Same march as castCircle()
+    const Fixed contact = 655;
+    const Fixed minStep = FIXED_ONE;
+    
+    Fixed traveled = 0;
+    Fixed gap = distanceAtFixed(x, y) - radius;
+    if (gap <= contact) return 0;
+    while (traveled < maxDistance) {
+        Fixed next = traveled + std::max(gap, minStep);
+        gap = distanceAtFixed(x + fixedMul(dirX, next), y + fixedMul(dirY, next)) - radius;
+        if (gap <= contact) {
+            for (int i = 0; i < 8; i++) {
+                Fixed middle = traveled + (next - traveled) / 2;
+                if (distanceAtFixed(x + fixedMul(dirX, middle), y + fixedMul(dirY, middle)) - radius <= contact) {
+                    next = middle;
+                } else {
+                    traveled = middle;
+                }
+            }
+            return std::min(next, maxDistance);
+        }
+        traveled = next;
+    }
+    return maxDistance;
+}
@@ -1,36 +1,69 @@
 #include "Match.h"
 #include "Room.h"
 #include "Player.h"
-#include "Map.h"
+#include "Replay.h"
+#include <chrono>
+#include <iostream>
+
+Match::Match(int id, Room* room, const EntityStore& lobby, float width, float height)
+    : matchId(id), state(PREPARING), world(nullptr), sourceRoom(room), recording(nullptr),
+      ticksRun(0), lastTickMs(0.0), totalTickMs(0.0), maxTickMs(0.0) {
+    world = new SimWorld(width, height);
 
-Match::Match(int id, Room* room)
-    : matchId(id), state(PREPARING), gameMap(nullptr), sourceRoom(room) {
     // Copy players from room
     if (room != nullptr) {
-        players = room->players;
+        for (EntityHandle handle : room->players) {
+            const PlayerBody* body = lobby.body(handle);
+            if (body != nullptr) {
+                addPlayer(*body, *lobby.get(handle), handle);
+            }
+        }
     }
 }
 
 Match::~Match() {
-    // Cleanup handled by Game
+    delete world;
 }
 
 void Match::start() {
-    state = IN_PROGRESS;
-    // Initialize game map if not already set
-    if (gameMap == nullptr && sourceRoom != nullptr) {
-        // Map will be created by Game class before calling start()
-        // This is just a placeholder for future initialization
+    world->reset();
+    world->spawnPlayers();
+    ticksRun = 0;
+    lastTickMs = 0.0;
+    totalTickMs = 0.0;
+    maxTickMs = 0.0;
+    if (recording != nullptr) {
+        recording->begin(*world);
     }
+    state = IN_PROGRESS;
 }
 
 void Match::update() {
     if (state == IN_PROGRESS) {
-        // Update match logic
+        if (recording != nullptr) {
+            recording->recordTick(pendingInputs);
+        }
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        world->step(pendingInputs);
+        lastTickMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        ticksRun++;
+        totalTickMs += lastTickMs;
+        if (lastTickMs > maxTickMs) {
+            maxTickMs = lastTickMs;
+        }
+
+        if (world->matchOver) {
+            end();
+        }
     }
+    pendingInputs.clear();
 }
 
 void Match::end() {
+    if (recording != nullptr) {
+        recording->finish(*world);
+    }
     state = ENDED;
 }
 
@@ -38,16 +71,38 @@ bool Match::isActive() const {
     return state == IN_PROGRESS;
 }
 
-void Match::addPlayer(Player* player) {
-    players.push_back(player);
+EntityHandle Match::addPlayer(const PlayerBody& body, const Player& player, EntityHandle lobbyHandle) {
+    EntityHandle handle = world->addPlayer(body, player);
+    players.push_back(handle);
+    lobbyHandles.push_back(lobbyHandle);
+    return handle;
 }
 
-void Match::removePlayer(Player* player) {
-    for (auto it = players.begin(); it != players.end(); ++it) {
-        if (*it == player) {
-            players.erase(it);
+void Match::removePlayer(EntityHandle player) {
+    for (size_t i = 0; i < players.size(); i++) {
+        if (players[i] == player) {
+            world->removePlayer(player);
+            players.erase(players.begin() + i);
+            lobbyHandles.erase(lobbyHandles.begin() + i);
             break;
         }
     }
 }
 
+EntityHandle Match::worldHandle(EntityHandle lobbyHandle) const {
+    for (size_t i = 0; i < lobbyHandles.size(); i++) {
+        if (lobbyHandles[i] == lobbyHandle) {
+            return players[i];
+        }
+    }
+    return INVALID_ENTITY;
+}
+
+double Match::averageTickMs() const {
+    return ticksRun > 0 ? totalTickMs / ticksRun : 0.0;
+}
+
+void Match::printTickTimes() const {
+    std::cout << "Match " << matchId << ": " << ticksRun << " ticks, avg "
+              << averageTickMs() << " ms, max " << maxTickMs << " ms\n";
+}
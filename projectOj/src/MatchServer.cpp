@@ -0,0 +1,74 @@
+#include "MatchServer.h"
+#include "Match.h"
+#include "JobSystem.h"
+
+MatchServer::MatchServer(float mapWidth, float mapHeight, JobSystem* jobs)
+    : jobs(jobs), mapWidth(mapWidth), mapHeight(mapHeight), tickRate(60), deterministic(false), nextMatchId(1) {
+}
+
+MatchServer::~MatchServer() {
+    for (Match* match : matches) {
+        delete match;
+    }
+}
+
+Match* MatchServer::createMatch(Room* room, const EntityStore& lobby) {
+    Match* match = new Match(nextMatchId++, room, lobby, mapWidth, mapHeight);
+    match->world->setTickRate(tickRate);
+    match->world->setDeterministic(deterministic);
+    match->start();
+    matches.push_back(match);
+    return match;
+}
+
+Match* MatchServer::findMatch(int matchId) {
+    for (Match* match : matches) {
+        if (match->matchId == matchId) {
+            return match;
+        }
+    }
+    return nullptr;
+}
+
+void MatchServer::removeEndedMatches() {
+    size_t kept = 0;
+    for (size_t i = 0; i < matches.size(); i++) {
+        if (matches[i]->state == Match::ENDED) {
+            delete matches[i];
+        } else {
+            matches[kept++] = matches[i];
+        }
+    }
+    matches.resize(kept);
+}
+
+void MatchServer::tick() {
+    int count = (int)matches.size();
+    if (jobs == nullptr) {
+        for (Match* match : matches) {
+            match->update();
+        }
+        return;
+    }
+    jobs->parallelFor(count, 1, [this](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            matches[i]->update();
+        }
+    });
+}
+
+int MatchServer::activeCount() const {
+    int count = 0;
+    for (const Match* match : matches) {
+        if (match->isActive()) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void MatchServer::printTickTimes() const {
+    for (const Match* match : matches) {
+        match->printTickTimes();
+    }
+}
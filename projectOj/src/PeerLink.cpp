@@ -0,0 +1,203 @@
+#include "PeerLink.h"
+#include "Rollback.h"
+#include "ByteStream.h"
+#include <enet/enet.h>
+#include <iostream>
+
+// First byte of every packet
+static const unsigned char MESSAGE_INPUT = 1;
+static const unsigned char MESSAGE_START = 2;
+
+static const int CHANNEL_COUNT = 2;
+
+PeerLink::PeerLink()
+    : host(nullptr), peer(nullptr), hosting(false), remotePlayerId(-1), peerAck(0), localAck(0), startReceived(false), startSeed(0),
+      startTickRate(60), startDeterministic(false) {
+    if (enet_initialize() != 0) {
+        std::cout << "Could not initialize ENet\n";
+    }
+}
+
+PeerLink::~PeerLink() {
+    if (peer != nullptr) {
+        enet_peer_disconnect_now(peer, 0);
+    }
+    if (host != nullptr) {
+        enet_host_destroy(host);
+    }
+    enet_deinitialize();
+}
+
+bool PeerLink::listen(int port) {
+    ENetAddress address;
+    address.host = ENET_HOST_ANY;
+    address.port = (enet_uint16)port;
+    host = enet_host_create(&address, 1, CHANNEL_COUNT, 0, 0);
+    if (host == nullptr) {
+        std::cout << "Could not listen on port " << port << "\n";
+        return false;
+    }
+    hosting = true;
+    std::cout << "Waiting for a player on port " << port << "\n";
+    return true;
+}
+
+bool PeerLink::connect(const std::string& address, int port) {
+    host = enet_host_create(nullptr, 1, CHANNEL_COUNT, 0, 0);
+    if (host == nullptr) {
+        std::cout << "Could not create network host\n";
+        return false;
+    }
+
+    ENetAddress remote;
+    enet_address_set_host(&remote, address.c_str());
+    remote.port = (enet_uint16)port;
+    if (enet_host_connect(host, &remote, CHANNEL_COUNT, 0) == nullptr) {
+        std::cout << "Could not connect to " << address << ":" << port << "\n";
+        return false;
+    }
+    hosting = false;
+    std::cout << "Connecting to " << address << ":" << port << "\n";
+    return true;
+}
+
+bool PeerLink::isConnected() const {
+    return peer != nullptr;
+}
+
+void PeerLink::poll(RollbackSession* session) {
+    if (host == nullptr) return;
+
+    // Inputs that came in before there was a session to take them
+    if (session != nullptr && !pendingInputs.empty()) {
+        for (const PlayerInput& input : pendingInputs) {
+            session->addRemoteInput(input);
+            localAck = session->confirmedTickOf(input.playerId);
+        }
+        pendingInputs.clear();
+    }
+
+    ENetEvent event;
+    while (enet_host_service(host, &event, 0) > 0) {
+        switch (event.type) {
+            case ENET_EVENT_TYPE_CONNECT:
+                peer = event.peer;
+                remotePlayerId = hosting ? JOIN_PLAYER_ID : HOST_PLAYER_ID;
+                std::cout << "Player connected\n";
+                break;
+            case ENET_EVENT_TYPE_RECEIVE:
+                receive(event.packet->data, event.packet->dataLength, session);
+                enet_packet_destroy(event.packet);
+                break;
+            case ENET_EVENT_TYPE_DISCONNECT:
+                if (event.peer == peer) {
+                    peer = nullptr;
+                    std::cout << "Player disconnected\n";
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void PeerLink::receive(const unsigned char* bytes, size_t size, RollbackSession* session) {
+    ByteReader reader(bytes, size);
+    unsigned char type = reader.u8();
+
+    if (type == MESSAGE_START) {
+        startSeed = reader.u32();
+        startTickRate = (int)reader.u32();
+        startDeterministic = reader.u8() != 0;
+        startReceived = reader.ok;
+        // Anything buffered so far belongs to the last match; the host
+        // resends this match's inputs until we ack them
+        pendingInputs.clear();
+    } else if (type == MESSAGE_INPUT) {
+        int playerId = (int)reader.u32();
+        if (playerId != remotePlayerId) return;  // The peer may only send its own inputs
+        unsigned int ack = reader.u32();
+        unsigned int count = reader.u8();
+        for (unsigned int i = 0; i < count; i++) {
+            PlayerInput input;
+            input.playerId = playerId;
+            if (!input.read(reader)) break;
+            if (session != nullptr) {
+                session->addRemoteInput(input);
+            } else {
+                bufferInput(input);
+            }
+        }
+        if (session != nullptr) {
+            localAck = session->confirmedTickOf(playerId);
+        }
+
+        // An ack past anything we sent is a leftover from an earlier match
+        if (reader.ok && !recentInputs.empty() && ack <= recentInputs.back().tick + 1 && ack > peerAck) {
+            peerAck = ack;
+            size_t acked = 0;
+            while (acked < recentInputs.size() && recentInputs[acked].tick < peerAck) {
+                acked++;
+            }
+            recentInputs.erase(recentInputs.begin(), recentInputs.begin() + acked);
+        }
+    }
+}
+
+void PeerLink::bufferInput(const PlayerInput& input) {
+    // Every packet repeats the unacked inputs, so most arrive several times
+    for (const PlayerInput& pending : pendingInputs) {
+        if (pending.tick == input.tick && pending.playerId == input.playerId) return;
+    }
+    if ((int)pendingInputs.size() < MAX_UNACKED) {
+        pendingInputs.push_back(input);
+    }
+}
+
+void PeerLink::sendInput(const PlayerInput& input) {
+    recentInputs.push_back(input);
+    if ((int)recentInputs.size() > MAX_UNACKED) {
+        recentInputs.erase(recentInputs.begin());
+    }
+    resendInputs();
+}
+
+void PeerLink::resendInputs() {
+    if (peer == nullptr || recentInputs.empty()) return;
+
+    std::vector<unsigned char> bytes;
+    bytes.push_back(MESSAGE_INPUT);
+    putU32(bytes, (unsigned int)recentInputs.back().playerId);
+    putU32(bytes, localAck);
+    bytes.push_back((unsigned char)recentInputs.size());
+    for (const PlayerInput& recent : recentInputs) {
+        recent.write(bytes);
+    }
+
+    ENetPacket* packet = enet_packet_create(bytes.data(), bytes.size(), 0);
+    enet_peer_send(peer, CHANNEL_INPUT, packet);
+    enet_host_flush(host);  // Don't wait for the next poll; every millisecond is a smaller rollback
+}
+
+void PeerLink::sendStart(unsigned int seed, int tickRate, bool deterministic) {
+    if (peer == nullptr) return;
+
+    std::vector<unsigned char> bytes;
+    bytes.push_back(MESSAGE_START);
+    putU32(bytes, seed);
+    putU32(bytes, (unsigned int)tickRate);
+    bytes.push_back(deterministic ? 1 : 0);
+
+    ENetPacket* packet = enet_packet_create(bytes.data(), bytes.size(), ENET_PACKET_FLAG_RELIABLE);
+    enet_peer_send(peer, CHANNEL_CONTROL, packet);
+    enet_host_flush(host);
+}
+
+void PeerLink::resetInputs() {
+    // pendingInputs stays: the joining side resets after the host's start
+    // message, when the host's first inputs may already be waiting
+    recentInputs.clear();
+    peerAck = 0;
+    localAck = 0;
+    startReceived = false;
+}
@@ -1,281 +1,123 @@
 #include "Player.h"
 #include "Bullet.h"
+#include "Map.h"
+#include "InputCmd.h"
+#include "FastMath.h"
+#ifndef OJ_HEADLESS
 #include <GL/freeglut.h>
+#endif
 #include <cmath>
 
-Player::Player() {
-    id = -1;
+PlayerBody::PlayerBody() {
     x = 0.0f;
     y = 0.0f;
-    speed = 2.0f;  // Speed per update (updates ~60 times per second)
+    speed = 120.0f;  // Units per second
     size = 20.0f;
-    angle = 0.0f;
+    id = -1;
     isAlive = true;
-    // Initialize key states
-    for (int i = 0; i < 256; i++) {
-        keys[i] = false;
-    }
-    keyUp = false;
-    keyDown = false;
-    keyLeft = false;
-    keyRight = false;
+    syncFixed();
 }
 
-Player::Player(int id, float x, float y) {
-    this->id = id;
+PlayerBody::PlayerBody(int id, float x, float y) {
     this->x = x;
     this->y = y;
-    speed = 2.0f;  // Speed per update (updates ~60 times per second)
+    speed = 120.0f;  // Units per second
     size = 20.0f;
-    angle = 0.0f;
+    this->id = id;
     isAlive = true;
-    // Initialize key states
-    for (int i = 0; i < 256; i++) {
-        keys[i] = false;
-    }
-    keyUp = false;
-    keyDown = false;
-    keyLeft = false;
-    keyRight = false;
-}
-
-void Player::moveUp() {
-    y += speed;
-}
-
-void Player::moveDown() {
-    y -= speed;
-}
-
-void Player::moveLeft() {
-    x -= speed;
-}
-
-void Player::moveRight() {
-    x += speed;
+    syncFixed();
 }
 
-void Player::moveUpRight() {
-    // Diagonal movement: normalize speed for 45-degree angle
-    float diagonalSpeed = speed * 0.707f; // sqrt(2)/2 ≈ 0.707
-    x += diagonalSpeed;
-    y += diagonalSpeed;
-}
-
-void Player::moveUpLeft() {
-    float diagonalSpeed = speed * 0.707f;
-    x -= diagonalSpeed;
-    y += diagonalSpeed;
-}
-
-void Player::moveDownLeft() {
-    float diagonalSpeed = speed * 0.707f;
-    x -= diagonalSpeed;
-    y -= diagonalSpeed;
-}
-
-void Player::moveDownRight() {
-    float diagonalSpeed = speed * 0.707f;
-    x += diagonalSpeed;
-    y -= diagonalSpeed;
-}
-
-void Player::handleKey(unsigned char key, bool pressed) {
-    keys[key] = pressed;
-}
-
-void Player::handleSpecialKey(int key, bool pressed) {
-    switch (key) {
-        case GLUT_KEY_UP:
-            keyUp = pressed;
-            break;
-        case GLUT_KEY_DOWN:
-            keyDown = pressed;
-            break;
-        case GLUT_KEY_LEFT:
-            keyLeft = pressed;
-            break;
-        case GLUT_KEY_RIGHT:
-            keyRight = pressed;
-            break;
-    }
-}
-
-void Player::updateMovement() {
-    if (!isAlive) return;  // Dead players can't move
-    
-    // Check WASD keys first
-    bool w = keys['w'] || keys['W'];
-    bool s = keys['s'] || keys['S'];
-    bool a = keys['a'] || keys['A'];
-    bool d = keys['d'] || keys['D'];
-    
-    // Check arrow keys
-    bool up = keyUp;
-    bool down = keyDown;
-    bool left = keyLeft;
-    bool right = keyRight;
-    
-    // Use arrow keys if pressed, otherwise use WASD
-    bool shouldMoveUp = up || w;
-    bool shouldMoveDown = down || s;
-    bool shouldMoveLeft = left || a;
-    bool shouldMoveRight = right || d;
-    
-    // Check for diagonal movements first
-    if (shouldMoveUp && shouldMoveRight) {
-        moveUpRight();  // WD or Up+Right
-    }
-    else if (shouldMoveUp && shouldMoveLeft) {
-        moveUpLeft();   // WA or Up+Left
-    }
-    else if (shouldMoveDown && shouldMoveLeft) {
-        moveDownLeft(); // SA or Down+Left
-    }
-    else if (shouldMoveDown && shouldMoveRight) {
-        moveDownRight(); // SD or Down+Right
-    }
-    // Single direction movements
-    else if (shouldMoveUp) {
-        moveUp();
-    }
-    else if (shouldMoveDown) {
-        moveDown();
-    }
-    else if (shouldMoveLeft) {
-        moveLeft();
-    }
-    else if (shouldMoveRight) {
-        moveRight();
-    }
-}
-
-bool Player::tryMoveTo(float newX, float newY, bool (*checkCollision)(float x, float y, float radius)) {
-    if (checkCollision == nullptr) {
-        x = newX;
-        y = newY;
-        return true;
-    }
-    
-    if (!checkCollision(newX, newY, size / 2.0f)) {
-        x = newX;
-        y = newY;
-        return true;
-    }
-    return false;
+Player::Player() {
+    prevX = 0.0f;
+    prevY = 0.0f;
+    aimX = 0.0f;     // Arrow points up
+    aimY = 1.0f;
+    kills = 0;
+    syncFixed();
 }
 
-void Player::updateMovementWithCollision(bool (*checkCollision)(float x, float y, float radius)) {
+void PlayerBody::updateMovementWithCollision(const InputCmd& input, const Map* map, float dt) {
     if (!isAlive) return;
     
-    float oldX = x;
-    float oldY = y;
-    
-    // Check WASD keys first
-    bool w = keys['w'] || keys['W'];
-    bool s = keys['s'] || keys['S'];
-    bool a = keys['a'] || keys['A'];
-    bool d = keys['d'] || keys['D'];
-    
-    // Check arrow keys
-    bool up = keyUp;
-    bool down = keyDown;
-    bool left = keyLeft;
-    bool right = keyRight;
+    bool shouldMoveUp = input.held(InputCmd::UP);
+    bool shouldMoveDown = input.held(InputCmd::DOWN);
+    bool shouldMoveLeft = input.held(InputCmd::LEFT);
+    bool shouldMoveRight = input.held(InputCmd::RIGHT);
     
-    bool shouldMoveUp = up || w;
-    bool shouldMoveDown = down || s;
-    bool shouldMoveLeft = left || a;
-    bool shouldMoveRight = right || d;
-    
-    // Calculate desired movement
+    // Calculate desired movement for this tick
+    float step = speed * dt;
     float deltaX = 0.0f;
     float deltaY = 0.0f;
     
     // Handle diagonal movement first
     if (shouldMoveUp && shouldMoveRight) {
-        float diagonalSpeed = speed * 0.707f;
+        float diagonalSpeed = step * 0.707f;
         deltaX = diagonalSpeed;
         deltaY = diagonalSpeed;
     }
     else if (shouldMoveUp && shouldMoveLeft) {
-        float diagonalSpeed = speed * 0.707f;
+        float diagonalSpeed = step * 0.707f;
         deltaX = -diagonalSpeed;
         deltaY = diagonalSpeed;
     }
     else if (shouldMoveDown && shouldMoveLeft) {
-        float diagonalSpeed = speed * 0.707f;
+        float diagonalSpeed = step * 0.707f;
         deltaX = -diagonalSpeed;
         deltaY = -diagonalSpeed;
     }
     else if (shouldMoveDown && shouldMoveRight) {
-        float diagonalSpeed = speed * 0.707f;
+        float diagonalSpeed = step * 0.707f;
         deltaX = diagonalSpeed;
         deltaY = -diagonalSpeed;
     }
     // Handle single-axis movement
     else {
         if (shouldMoveUp) {
-            deltaY = speed;
+            deltaY = step;
         }
         if (shouldMoveDown) {
-            deltaY = -speed;
+            deltaY = -step;
         }
         if (shouldMoveLeft) {
-            deltaX = -speed;
+            deltaX = -step;
         }
         if (shouldMoveRight) {
-            deltaX = speed;
+            deltaX = step;
         }
     }
     
-    // Try to move with collision detection
-    float newX = x + deltaX;
-    float newY = y + deltaY;
+    if (deltaX == 0.0f && deltaY == 0.0f) return;
     
-    // Try full movement first (diagonal or single-axis)
-    if (deltaX != 0.0f || deltaY != 0.0f) {
-        if (tryMoveTo(newX, newY, checkCollision)) {
-            // Movement successful
-            return;
-        }
-        
-        // If diagonal movement failed, try single-axis movement
-        if (deltaX != 0.0f && deltaY != 0.0f) {
-            // Try X-axis only
-            if (tryMoveTo(x + deltaX, y, checkCollision)) {
-                return;
-            }
-            // Try Y-axis only
-            if (tryMoveTo(x, y + deltaY, checkCollision)) {
-                return;
-            }
-        }
+    // Stop at walls and slide along them
+    if (map != nullptr) {
+        map->moveCircle(x, y, size / 2.0f, deltaX, deltaY);
+    } else {
+        x += deltaX;
+        y += deltaY;
     }
 }
 
-void Player::updateAim(float mouseX, float mouseY) {
-    float dx = mouseX - x;
-    float dy = mouseY - y;
-    // atan2 returns angle from positive X axis (0 = right)
-    // Arrow points up at angle 0, so we need to subtract π/2 to align
-    angle = atan2(dy, dx) - 3.14159f / 2.0f;
+void Player::setAim(int aim) {
+    fixedAngle = aim;
+    fastSinCos(angleToRadians(aim), aimY, aimX);
 }
 
-void Player::getBulletSpawnPosition(float& outX, float& outY) {
+void Player::getBulletSpawnPosition(const PlayerBody& body, float& outX, float& outY) const {
     // Spawn bullet slightly in front of the player (at the tip of the arrow)
-    float offset = size / 2.0f + 5.0f;  // 5 pixels beyond the arrow tip
-    float adjustedAngle = angle + 3.14159f / 2.0f;  // Convert back to standard angle
-    outX = x + cos(adjustedAngle) * offset;
-    outY = y + sin(adjustedAngle) * offset;
+    float offset = body.size / 2.0f + 5.0f;  // 5 pixels beyond the arrow tip
+    outX = body.x + aimX * offset;
+    outY = body.y + aimY * offset;
 }
 
-void Player::render() {
-    if (!isAlive) return;  // Don't render dead players
+#ifndef OJ_HEADLESS
+void Player::render(const PlayerBody& body) {
+    if (!body.isAlive) return;  // Don't render dead players
     
+    float size = body.size;
     glPushMatrix();
-    glTranslatef(x, y, 0.0f);
-    glRotatef(angle * 180.0f / 3.14159f, 0.0f, 0.0f, 1.0f);
+    glTranslatef(body.x, body.y, 0.0f);
+    rotateToAim();
     
     glColor3f(0.0f, 0.0f, 1.0f);
     glBegin(GL_TRIANGLES);
@@ -287,6 +129,78 @@ void Player::render() {
     glPopMatrix();
 }
 
-void Player::eliminate() {
+void Player::rotateToAim() const {
+    // Columns are where +x and +y end up; +y goes to the aim
+    const GLfloat rotation[16] = {
+        aimY, -aimX, 0.0f, 0.0f,
+        aimX, aimY, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f,
+    };
+    glMultMatrixf(rotation);
+}
+#endif
+
+void PlayerBody::eliminate() {
     isAlive = false;
 }
+
+void PlayerBody::syncFixed() {
+    fixedX = toFixed(x);
+    fixedY = toFixed(y);
+}
+
+void Player::syncFixed() {
+    fixedAngle = fixedAtan2(toFixed(aimY), toFixed(aimX));
+}
+
+void PlayerBody::updateMovementFixed(const InputCmd& input, const Map* map, Fixed dt) {
+    if (!isAlive) return;
+    
+    const Fixed diagonalFactor = 46341;  // 1 / sqrt(2)
+    Fixed step = fixedMul(toFixed(speed), dt);
+    Fixed diagonal = fixedMul(step, diagonalFactor);
+    Fixed deltaX = 0;
+    Fixed deltaY = 0;
+    
+    // Same key rules as updateMovementWithCollision
+    if (input.held(InputCmd::UP) && input.held(InputCmd::RIGHT)) {
+        deltaX = diagonal;
+        deltaY = diagonal;
+    }
+    else if (input.held(InputCmd::UP) && input.held(InputCmd::LEFT)) {
+        deltaX = -diagonal;
+        deltaY = diagonal;
+    }
+    else if (input.held(InputCmd::DOWN) && input.held(InputCmd::LEFT)) {
+        deltaX = -diagonal;
+        deltaY = -diagonal;
+    }
+    else if (input.held(InputCmd::DOWN) && input.held(InputCmd::RIGHT)) {
+        deltaX = diagonal;
+        deltaY = -diagonal;
+    }
+    else {
+        if (input.held(InputCmd::UP)) deltaY = step;
+        if (input.held(InputCmd::DOWN)) deltaY = -step;
+        if (input.held(InputCmd::LEFT)) deltaX = -step;
+        if (input.held(InputCmd::RIGHT)) deltaX = step;
+    }
+    
+    if (deltaX == 0 && deltaY == 0) return;
+    
+    if (map != nullptr) {
+        map->moveCircleFixed(fixedX, fixedY, toFixed(size / 2.0f), deltaX, deltaY);
+    } else {
+        fixedX += deltaX;
+        fixedY += deltaY;
+    }
+    x = fromFixed(fixedX);
+    y = fromFixed(fixedY);
+}
+
+void Player::getBulletSpawnPositionFixed(const PlayerBody& body, Fixed& outX, Fixed& outY) const {
+    Fixed offset = toFixed(body.size / 2.0f + 5.0f);
+    outX = body.fixedX + fixedMul(fixedCos(fixedAngle), offset);
+    outY = body.fixedY + fixedMul(fixedSin(fixedAngle), offset);
+}
@@ -0,0 +1,91 @@
+#include "PositionHistory.h"
+#include "EntityStore.h"
+#include <algorithm>
+
+PositionHistory::PositionHistory(int ticks)
+    : capacity(ticks > 1 ? ticks : 2), columns(0), shift(0), rowTick(capacity, (unsigned int)NO_TICK) {
+}
+
+void PositionHistory::setBounds(float width, float height) {
+    // Smallest step that still fits the whole map into 16 bits
+    long long extent = toFixed(std::max(width, height));
+    shift = 0;
+    while ((extent >> shift) > 0xFFFF) {
+        shift++;
+    }
+    clear();
+}
+
+void PositionHistory::clear() {
+    std::fill(rowTick.begin(), rowTick.end(), (unsigned int)NO_TICK);
+}
+
+unsigned short PositionHistory::quantize(Fixed value) const {
+    int q = value >> shift;
+    return (unsigned short)std::min(std::max(q, 0), 0xFFFF);
+}
+
+void PositionHistory::record(unsigned int tick, const EntityStore& entities, bool fixedPositions) {
+    int players = entities.size();
+    if (players != columns) {
+        columns = players;
+        x.assign((size_t)capacity * columns, 0);
+        y.assign((size_t)capacity * columns, 0);
+        clear();
+    }
+
+    int row = (int)(tick % capacity);
+    rowTick[row] = tick;
+    unsigned short* rowX = x.data() + (size_t)row * columns;
+    unsigned short* rowY = y.data() + (size_t)row * columns;
+    for (int p = 0; p < players; p++) {
+        const PlayerBody& body = entities.bodies[p];
+        rowX[p] = quantize(fixedPositions ? body.fixedX : toFixed(body.x));
+        rowY[p] = quantize(fixedPositions ? body.fixedY : toFixed(body.y));
+    }
+}
+
+bool PositionHistory::holds(unsigned int tick) const {
+    return rowTick[tick % capacity] == tick;
+}
+
+Fixed PositionHistory::positionX(unsigned int tick, int p) const {
+    return (Fixed)x[(size_t)(tick % capacity) * columns + p] << shift;
+}
+
+Fixed PositionHistory::positionY(unsigned int tick, int p) const {
+    return (Fixed)y[(size_t)(tick % capacity) * columns + p] << shift;
+}
+
+bool PositionHistory::rewind(int p, unsigned int tick, Fixed ticksBack, Fixed& outX, Fixed& outY) const {
+    if (p >= columns || !holds(tick)) return false;
+
+    unsigned int whole = (unsigned int)(ticksBack >> FIXED_SHIFT);
+    Fixed fraction = ticksBack & (FIXED_ONE - 1);
+    if (whole > tick) {
+        whole = tick;
+        fraction = 0;
+    }
+    while (whole > 0 && !holds(tick - whole)) {
+        whole--;
+        fraction = 0;
+    }
+
+    unsigned int newer = tick - whole;
+    Fixed newerX = positionX(newer, p);
+    Fixed newerY = positionY(newer, p);
+    if (fraction == 0 || newer == 0 || !holds(newer - 1)) {
+        outX = newerX;
+        outY = newerY;
+        return true;
+    }
+
+    // Tick-to-tick steps are small, so the products stay far from overflow
+    outX = newerX + fixedMul(positionX(newer - 1, p) - newerX, fraction);
+    outY = newerY + fixedMul(positionY(newer - 1, p) - newerY, fraction);
+    return true;
+}
+
+size_t PositionHistory::memoryBytes() const {
+    return (x.size() + y.size()) * sizeof(unsigned short) + rowTick.size() * sizeof(unsigned int);
+}
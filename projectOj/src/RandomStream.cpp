@@ -0,0 +1,70 @@
+#include "RandomStream.h"
+
+// Round multipliers and key schedule constants from the Philox paper
+static const unsigned int PHILOX_M0 = 0xD2511F53u;
+static const unsigned int PHILOX_M1 = 0xCD9E8D57u;
+static const unsigned int PHILOX_W0 = 0x9E3779B9u;
+static const unsigned int PHILOX_W1 = 0xBB67AE85u;
+static const int PHILOX_ROUNDS = 10;
+
+RandomStream::RandomStream(unsigned int seed, unsigned int subsystem, unsigned int entity, unsigned int tick)
+    : used(4) {
+    key[0] = seed;
+    key[1] = subsystem;
+    counter[0] = entity;
+    counter[1] = tick;
+    counter[2] = 0;         // Block index within the stream
+    counter[3] = 0;
+}
+
+void RandomStream::block(const unsigned int counter[4], const unsigned int key[2], unsigned int out[4]) {
+    unsigned int c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    unsigned int k0 = key[0], k1 = key[1];
+    for (int round = 0; round < PHILOX_ROUNDS; round++) {
+        unsigned long long product0 = (unsigned long long)PHILOX_M0 * c0;
+        unsigned long long product1 = (unsigned long long)PHILOX_M1 * c2;
+        unsigned int hi0 = (unsigned int)(product0 >> 32), lo0 = (unsigned int)product0;
+        unsigned int hi1 = (unsigned int)(product1 >> 32), lo1 = (unsigned int)product1;
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = lo0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+unsigned int RandomStream::next() {
+    if (used == 4) {
+        block(counter, key, buffer);
+        counter[2]++;
+        used = 0;
+    }
+    return buffer[used++];
+}
+
+unsigned int RandomStream::below(unsigned int bound) {
+    // Lemire's multiply-shift; the rejection keeps it exactly uniform
+    unsigned long long product = (unsigned long long)next() * bound;
+    unsigned int low = (unsigned int)product;
+    if (low < bound) {
+        unsigned int threshold = (0u - bound) % bound;
+        while (low < threshold) {
+            product = (unsigned long long)next() * bound;
+            low = (unsigned int)product;
+        }
+    }
+    return (unsigned int)(product >> 32);
+}
+
+Fixed RandomStream::fixedUnit() {
+    return (Fixed)(next() >> (32 - FIXED_SHIFT));
+}
+
+float RandomStream::unit() {
+    return (float)(next() >> 8) * (1.0f / 16777216.0f);
+}
@@ -0,0 +1,160 @@
+#include "RectBVH.h"
+#include "Map.h"
+#include <algorithm>
+
+// Deep enough for any median-split tree over an int-indexed rect set
+static const int STACK_SIZE = 64;
+
+static bool boxOverlapsCircle(const RectBVH::Node& node, float x, float y, float radius) {
+    float closestX = (x < node.minX) ? node.minX : ((x > node.maxX) ? node.maxX : x);
+    float closestY = (y < node.minY) ? node.minY : ((y > node.maxY) ? node.maxY : y);
+    float dx = x - closestX;
+    float dy = y - closestY;
+    return dx * dx + dy * dy <= radius * radius;
+}
+
+void RectBVH::build(const std::vector<Rect>& rects) {
+    clear();
+    if (rects.empty()) return;
+
+    order.resize(rects.size());
+    for (size_t i = 0; i < rects.size(); i++) {
+        order[i] = (int)i;
+    }
+    nodes.reserve(2 * rects.size() / LEAF_SIZE + 1);
+    buildNode(rects, 0, (int)rects.size());
+}
+
+void RectBVH::clear() {
+    nodes.clear();
+    order.clear();
+}
+
+int RectBVH::buildNode(const std::vector<Rect>& rects, int begin, int end) {
+    int index = (int)nodes.size();
+    nodes.push_back(Node());
+
+    Node node;
+    node.minX = node.minY = 1e30f;
+    node.maxX = node.maxY = -1e30f;
+    float centerMinX = 1e30f, centerMinY = 1e30f;
+    float centerMaxX = -1e30f, centerMaxY = -1e30f;
+    for (int i = begin; i < end; i++) {
+        const Rect& r = rects[order[i]];
+        node.minX = std::min(node.minX, r.left);
+        node.maxX = std::max(node.maxX, r.right);
+        node.minY = std::min(node.minY, r.bottom);
+        node.maxY = std::max(node.maxY, r.top);
+
+        float cx = (r.left + r.right) * 0.5f;
+        float cy = (r.bottom + r.top) * 0.5f;
+        centerMinX = std::min(centerMinX, cx);
+        centerMaxX = std::max(centerMaxX, cx);
+        centerMinY = std::min(centerMinY, cy);
+        centerMaxY = std::max(centerMaxY, cy);
+    }
+
+    if (end - begin <= LEAF_SIZE) {
+        node.first = begin;
+        node.count = end - begin;
+        nodes[index] = node;
+        return index;
+    }
+
+    // Median split along the axis where rect centers are most spread out
+    bool splitX = (centerMaxX - centerMinX) >= (centerMaxY - centerMinY);
+    int mid = (begin + end) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+        [&rects, splitX](int a, int b) {
+            const Rect& ra = rects[a];
+            const Rect& rb = rects[b];
+            if (splitX) {
+                return ra.left + ra.right < rb.left + rb.right;
+            }
+            return ra.bottom + ra.top < rb.bottom + rb.top;
+        });
+
+    buildNode(rects, begin, mid);               // Left child lands at index + 1
+    node.first = buildNode(rects, mid, end);    // Right child
+    node.count = 0;
+    nodes[index] = node;
+    return index;
+}
+
+bool RectBVH::overlapsCircle(const std::vector<Rect>& rects, float x, float y, float radius) const {
+    if (nodes.empty()) return false;
+
+    int stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        int index = stack[--top];
+        const Node& node = nodes[index];
+        if (!boxOverlapsCircle(node, x, y, radius)) continue;
+
+        if (node.count > 0) {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                if (rects[order[i]].checkCircleCollision(x, y, radius)) {
+                    return true;
+                }
+            }
+        } else {
+            stack[top++] = node.first;
+            stack[top++] = index + 1;
+        }
+    }
+    return false;
+}
+
+bool RectBVH::containsPoint(const std::vector<Rect>& rects, float x, float y) const {
+    if (nodes.empty()) return false;
+
+    int stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        int index = stack[--top];
+        const Node& node = nodes[index];
+        if (x < node.minX || x > node.maxX || y < node.minY || y > node.maxY) continue;
+
+        if (node.count > 0) {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                if (rects[order[i]].containsPoint(x, y)) {
+                    return true;
+                }
+            }
+        } else {
+            stack[top++] = node.first;
+            stack[top++] = index + 1;
+        }
+    }
+    return false;
+}
+
+void RectBVH::queryBox(const std::vector<Rect>& rects, float minX, float minY, float maxX, float maxY,
+                       std::vector<int>& out) const {
+    if (nodes.empty()) return;
+
+    int stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        int index = stack[--top];
+        const Node& node = nodes[index];
+        if (maxX < node.minX || minX > node.maxX || maxY < node.minY || minY > node.maxY) continue;
+
+        if (node.count > 0) {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                const Rect& r = rects[order[i]];
+                if (maxX < r.left || minX > r.right || maxY < r.bottom || minY > r.top) continue;
+                out.push_back(order[i]);
+            }
+        } else {
+            stack[top++] = node.first;
+            stack[top++] = index + 1;
+        }
+    }
+}
@@ -0,0 +1,264 @@
+#include "Replay.h"
+#include "Player.h"
+#include "Map.h"
+#include "ByteStream.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+// Flag bit beyond InputCmd::buttons: aim equals this player's previous one
+// and is not stored again
+static const unsigned char INPUT_AIM_SAME = 64;
+// Flag bit: a lag compensation view delay follows the aim
+static const unsigned char INPUT_VIEW_DELAY = 128;
+
+static const char MAGIC[4] = {'O', 'J', 'R', 'P'};
+
+Replay::Replay()
+    : seed(0), mapId(0), mapWidth(0.0f), mapHeight(0.0f), tickRate(60),
+      deterministic(false), tickCount(0), finalHash(0) {
+}
+
+void Replay::begin(const SimWorld& world) {
+    seed = world.seed;
+    mapId = Map::LAYOUT_ID;
+    mapWidth = world.width;
+    mapHeight = world.height;
+    tickRate = world.tickRate;
+    deterministic = world.deterministic;
+
+    roster.clear();
+    for (const PlayerBody& body : world.entities.bodies) {
+        roster.push_back(body.id);
+    }
+
+    tickCount = 0;
+    finalHash = 0;
+    data.clear();
+    recordedAim.assign(roster.size(), -1);
+}
+
+int Replay::rosterIndex(int playerId) const {
+    for (size_t i = 0; i < roster.size(); i++) {
+        if (roster[i] == playerId) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void Replay::recordTick(const std::vector<PlayerInput>& inputs) {
+    // The world ignores inputs for players it doesn't have, so dropping them is exact
+    int count = 0;
+    for (const PlayerInput& input : inputs) {
+        if (rosterIndex(input.playerId) >= 0) count++;
+    }
+    putVarint(data, count);
+
+    for (const PlayerInput& input : inputs) {
+        int index = rosterIndex(input.playerId);
+        if (index < 0) continue;
+
+        unsigned char flags = input.buttons;
+        if (input.held(InputCmd::AIM) && recordedAim[index] == input.aim) {
+            flags |= INPUT_AIM_SAME;
+        }
+        if (input.viewDelay != 0.0f) {
+            flags |= INPUT_VIEW_DELAY;
+        }
+
+        putVarint(data, index);
+        data.push_back(flags);
+        if (input.held(InputCmd::AIM) && !(flags & INPUT_AIM_SAME)) {
+            putU16(data, input.aim);
+            recordedAim[index] = input.aim;
+        }
+        if (flags & INPUT_VIEW_DELAY) {
+            putFloat(data, input.viewDelay);
+        }
+    }
+    tickCount++;
+}
+
+void Replay::finish(const SimWorld& world) {
+    finalHash = world.stateHash();
+}
+
+size_t Replay::readTick(size_t offset, std::vector<PlayerInput>& inputs,
+                        std::vector<unsigned short>& lastAim) const {
+    ByteReader reader(data.data(), data.size(), offset);
+    inputs.clear();
+
+    unsigned int count = reader.varint();
+    for (unsigned int i = 0; i < count && reader.ok; i++) {
+        unsigned int index = reader.varint();
+        unsigned char flags = reader.u8();
+        if (index >= roster.size()) {
+            reader.ok = false;
+            break;
+        }
+
+        PlayerInput input;
+        input.playerId = roster[index];
+        input.buttons = flags & ~(INPUT_AIM_SAME | INPUT_VIEW_DELAY);
+        if (input.held(InputCmd::AIM) && !(flags & INPUT_AIM_SAME)) {
+            lastAim[index] = reader.u16();
+        }
+        if (input.held(InputCmd::AIM)) {
+            input.aim = lastAim[index];
+        }
+        if (flags & INPUT_VIEW_DELAY) {
+            input.viewDelay = reader.f32();
+        }
+        inputs.push_back(input);
+    }
+
+    if (!reader.ok) {
+        inputs.clear();
+        return data.size();
+    }
+    return reader.offset;
+}
+
+void Replay::serialize(std::vector<unsigned char>& out) const {
+    out.assign(MAGIC, MAGIC + 4);
+    putU32(out, VERSION);
+    putU32(out, seed);
+    putU32(out, (unsigned int)mapId);
+    putFloat(out, mapWidth);
+    putFloat(out, mapHeight);
+    putU32(out, (unsigned int)tickRate);
+    out.push_back(deterministic ? 1 : 0);
+
+    putVarint(out, (unsigned int)roster.size());
+    for (int id : roster) {
+        putVarint(out, (unsigned int)id);
+    }
+
+    putU32(out, tickCount);
+    putU64(out, finalHash);
+    putU32(out, (unsigned int)data.size());
+    out.insert(out.end(), data.begin(), data.end());
+}
+
+bool Replay::deserialize(const unsigned char* bytes, size_t size) {
+    if (size < 4 || std::memcmp(bytes, MAGIC, 4) != 0) {
+        std::cout << "Not a replay file\n";
+        return false;
+    }
+
+    ByteReader reader(bytes, size, 4);
+    unsigned int version = reader.u32();
+    if (version != VERSION) {
+        std::cout << "Unsupported replay version " << version << "\n";
+        return false;
+    }
+
+    seed = reader.u32();
+    mapId = (int)reader.u32();
+    mapWidth = reader.f32();
+    mapHeight = reader.f32();
+    tickRate = (int)reader.u32();
+    deterministic = reader.u8() != 0;
+
+    unsigned int players = reader.varint();
+    roster.clear();
+    for (unsigned int i = 0; i < players && reader.ok; i++) {
+        roster.push_back((int)reader.varint());
+    }
+
+    tickCount = reader.u32();
+    finalHash = reader.u64();
+    unsigned int dataSize = reader.u32();
+    if (!reader.ok || dataSize > size - reader.offset) {
+        std::cout << "Replay file is truncated\n";
+        return false;
+    }
+    data.assign(bytes + reader.offset, bytes + reader.offset + dataSize);
+
+    if (mapId != Map::LAYOUT_ID) {
+        std::cout << "Replay was recorded on map layout " << mapId
+                  << ", this build has " << Map::LAYOUT_ID << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool Replay::save(const std::string& path) const {
+    std::vector<unsigned char> bytes;
+    serialize(bytes);
+
+    std::ofstream file(path.c_str(), std::ios::binary);
+    file.write((const char*)bytes.data(), bytes.size());
+    if (!file) {
+        std::cout << "Could not write replay " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool Replay::load(const std::string& path) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) {
+        std::cout << "Could not open replay " << path << "\n";
+        return false;
+    }
+    std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return deserialize(bytes.data(), bytes.size());
+}
+
+ReplayPlayer::ReplayPlayer(const Replay& replay, JobSystem* jobs)
+    : replay(replay), world(nullptr), jobs(jobs), readOffset(0) {
+    restart();
+}
+
+ReplayPlayer::~ReplayPlayer() {
+    delete world;
+}
+
+void ReplayPlayer::restart() {
+    // Same setup order as Game::startMatch / MatchServer::createMatch
+    delete world;
+    world = new SimWorld(replay.mapWidth, replay.mapHeight);
+    for (int id : replay.roster) {
+        world->addPlayer(PlayerBody(id, replay.mapWidth / 2, replay.mapHeight / 2));
+    }
+    world->seed = replay.seed;
+    world->setTickRate(replay.tickRate);
+    world->jobs = jobs;
+    world->setDeterministic(replay.deterministic);
+    world->reset();
+    world->spawnPlayers();
+
+    readOffset = 0;
+    lastAim.assign(replay.roster.size(), 0);
+}
+
+bool ReplayPlayer::step() {
+    if (finished()) return false;
+    readOffset = replay.readTick(readOffset, inputs, lastAim);
+    world->step(inputs);
+    return true;
+}
+
+void ReplayPlayer::seek(unsigned int tick) {
+    if (tick < world->tick) {
+        restart();
+    }
+    while (world->tick < tick && step()) {
+    }
+}
+
+void ReplayPlayer::runToEnd() {
+    while (step()) {
+    }
+}
+
+bool ReplayPlayer::finished() const {
+    return world->tick >= replay.tickCount || readOffset >= replay.data.size();
+}
+
+bool ReplayPlayer::matchesRecording() const {
+    return finished() && world->stateHash() == replay.finalHash;
+}
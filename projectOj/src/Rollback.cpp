@@ -0,0 +1,163 @@
+#include "Rollback.h"
+#include <chrono>
+
+RollbackSession::RollbackSession(SimWorld* world, int localPlayerId, const std::vector<int>& roster,
+                                 int maxBullets)
+    : world(world), snapshots(MAX_ROLLBACK + 1, (int)roster.size(), maxBullets), roster(roster),
+      localPlayerId(localPlayerId), rollbackFrom(NO_ROLLBACK), rollbacks(0), resimulatedTicks(0),
+      lateInputs(0), lastRollbackMs(0.0), maxRollbackMs(0.0) {
+    int players = (int)roster.size();
+    inputs.resize((size_t)HISTORY * players);
+    confirmed.assign((size_t)HISTORY * players, 0);
+    rowTick.assign(HISTORY, (unsigned int)NO_ROLLBACK);
+    latestInput.resize(players);
+    latestTick.assign(players, (unsigned int)NO_ROLLBACK);
+    confirmedUntil.assign(players, world->tick);
+    for (int c = 0; c < players; c++) {
+        latestInput[c].playerId = roster[c];
+    }
+    frameInputs.reserve(players);
+}
+
+int RollbackSession::column(int playerId) const {
+    for (size_t c = 0; c < roster.size(); c++) {
+        if (roster[c] == playerId) {
+            return (int)c;
+        }
+    }
+    return -1;
+}
+
+int RollbackSession::row(unsigned int tick) {
+    int r = (int)(tick % HISTORY);
+    if (rowTick[r] != tick) {
+        rowTick[r] = tick;
+        int players = (int)roster.size();
+        for (int c = 0; c < players; c++) {
+            inputs[(size_t)r * players + c] = PlayerInput();
+            inputs[(size_t)r * players + c].playerId = roster[c];
+            inputs[(size_t)r * players + c].tick = tick;
+            confirmed[(size_t)r * players + c] = 0;
+        }
+    }
+    return r;
+}
+
+void RollbackSession::addLocalInput(const PlayerInput& input) {
+    // The local player's input is real by definition, just not sent yet
+    PlayerInput stamped = input;
+    stamped.tick = world->tick;
+    addRemoteInput(stamped);
+}
+
+bool RollbackSession::addRemoteInput(const PlayerInput& input) {
+    unsigned int tick = input.tick;
+    int c = column(input.playerId);
+    if (c < 0) return false;
+    if (tick < confirmedUntil[c]) {
+        return true;    // Repeat of an input we already have
+    }
+
+    if (tick + MAX_ROLLBACK < world->tick) {
+        lateInputs++;   // Its snapshot is gone; the peers will drift apart
+        return false;
+    }
+    if (tick + MAX_ROLLBACK >= world->tick + HISTORY) {
+        return false;   // Would overwrite a row that a rollback may still need
+    }
+
+    int players = (int)roster.size();
+    size_t index = (size_t)row(tick) * players + c;
+    if (confirmed[index]) {
+        return true;
+    }
+
+    // Already simulated with a guess: re-run from here if the guess was wrong
+    if (tick < world->tick && !inputs[index].sameAs(input)) {
+        if (rollbackFrom == NO_ROLLBACK || tick < rollbackFrom) {
+            rollbackFrom = tick;
+        }
+    }
+    inputs[index] = input;
+    confirmed[index] = 1;
+
+    if (latestTick[c] == NO_ROLLBACK || tick >= latestTick[c]) {
+        latestInput[c] = input;
+        latestTick[c] = tick;
+    }
+    for (;;) {
+        unsigned int next = confirmedUntil[c];
+        int r = (int)(next % HISTORY);
+        if (rowTick[r] != next || !confirmed[(size_t)r * players + c]) break;
+        confirmedUntil[c] = next + 1;
+    }
+    return true;
+}
+
+void RollbackSession::fillPredictions(int r) {
+    int players = (int)roster.size();
+    for (int c = 0; c < players; c++) {
+        size_t index = (size_t)r * players + c;
+        if (confirmed[index]) continue;
+        // Keep moving and aiming as before; a predicted shot that didn't happen is worse than a late one
+        inputs[index] = latestInput[c];
+        inputs[index].tick = rowTick[r];
+        inputs[index].buttons &= ~InputCmd::FIRE;
+    }
+}
+
+void RollbackSession::simulate(unsigned int tick) {
+    int r = row(tick);
+    fillPredictions(r);
+    snapshots.save(*world);
+
+    int players = (int)roster.size();
+    frameInputs.assign(inputs.begin() + (size_t)r * players, inputs.begin() + (size_t)(r + 1) * players);
+    world->step(frameInputs);
+}
+
+void RollbackSession::advance() {
+    if (rollbackFrom != NO_ROLLBACK && rollbackFrom < world->tick) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        unsigned int present = world->tick;
+        if (snapshots.restore(*world, rollbackFrom)) {
+            while (world->tick < present && !world->matchOver) {
+                simulate(world->tick);
+                resimulatedTicks++;
+            }
+            rollbacks++;
+        }
+        lastRollbackMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (lastRollbackMs > maxRollbackMs) {
+            maxRollbackMs = lastRollbackMs;
+        }
+    }
+    rollbackFrom = NO_ROLLBACK;
+
+    if (!world->matchOver && canAdvance()) {
+        simulate(world->tick);
+    }
+}
+
+bool RollbackSession::canAdvance() const {
+    return world->tick < confirmedTick() + MAX_ROLLBACK;
+}
+
+unsigned int RollbackSession::confirmedTick() const {
+    unsigned int tick = world->tick;
+    for (unsigned int until : confirmedUntil) {
+        if (until < tick) {
+            tick = until;
+        }
+    }
+    return tick;
+}
+
+unsigned int RollbackSession::confirmedTickOf(int playerId) const {
+    int c = column(playerId);
+    return c < 0 ? 0 : confirmedUntil[c];
+}
+
+bool RollbackSession::matchDecided() const {
+    return world->matchOver && confirmedTick() >= world->tick;
+}
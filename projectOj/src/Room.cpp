@@ -1,5 +1,4 @@
 #include "Room.h"
-#include "Player.h"
 
 Room::Room(int id, const std::string& name, int maxPlayers)
     : roomId(id), roomName(name), maxPlayers(maxPlayers), status(WAITING) {
@@ -9,7 +8,7 @@ Room::~Room() {
     // Cleanup will be handled by Match/Game
 }
 
-bool Room::addPlayer(Player* player) {
+bool Room::addPlayer(EntityHandle player) {
     if (isFull() || status != WAITING) {
         return false;
     }
@@ -17,7 +16,7 @@ bool Room::addPlayer(Player* player) {
     return true;
 }
 
-bool Room::removePlayer(Player* player) {
+bool Room::removePlayer(EntityHandle player) {
     for (auto it = players.begin(); it != players.end(); ++it) {
         if (*it == player) {
             players.erase(it);
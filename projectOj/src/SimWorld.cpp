@@ -0,0 +1,632 @@
+#include "SimWorld.h"
+#include "Player.h"
+#include "Map.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+SimWorld::SimWorld(float w, float h)
+    : width(w), height(h), gameMap(nullptr), jobs(nullptr), tick(0), seed(0), tickRate(60), dt(1.0f / 60.0f),
+      deterministic(false), fixedDt(toFixed(1.0f / 60.0f)), matchOver(false), winnerId(-1) {
+    gameMap = Map::shared(w, h);
+    history.setBounds(w, h);
+}
+
+void SimWorld::step(const std::vector<PlayerInput>& inputs) {
+    if (matchOver) return;
+
+    // Remember where everything was so the renderer can interpolate
+    int playerCount = entities.size();
+    for (int p = 0; p < playerCount; p++) {
+        entities.players[p].prevX = entities.bodies[p].x;
+        entities.players[p].prevY = entities.bodies[p].y;
+    }
+
+    // Apply aim and fire commands first so bullets fired this tick move this tick
+    for (const PlayerInput& input : inputs) {
+        int p = findPlayer(input.playerId);
+        if (p < 0 || !entities.bodies[p].isAlive) continue;
+
+        Player& player = entities.players[p];
+        if (input.held(InputCmd::AIM)) {
+            player.setAim(input.aim);
+        }
+        if (input.held(InputCmd::FIRE)) {
+            spawnBullet(entities.bodies[p], player, input.viewDelay);
+        }
+    }
+
+    movePlayers(inputs);
+    buildPlayerGrid();      // Shared by separation and the bullet hit tests
+    separatePlayers();
+    history.record(tick, entities, deterministic);
+    updateBullets();
+    checkBulletCollisions();
+    cleanupBullets();
+    checkWinCondition();
+
+    tick++;
+}
+
+void SimWorld::setTickRate(int hz) {
+    if (hz > 0) {
+        tickRate = hz;
+        dt = 1.0f / hz;
+        fixedDt = toFixed(dt);
+    }
+}
+
+void SimWorld::setDeterministic(bool enabled) {
+    deterministic = enabled;
+    for (PlayerBody& body : entities.bodies) {
+        body.syncFixed();
+    }
+    for (Player& player : entities.players) {
+        player.syncFixed();
+    }
+}
+
+void SimWorld::parallelFor(int count, int chunkSize, const JobSystem::RangeJob& job) {
+    if (jobs != nullptr) {
+        jobs->parallelFor(count, chunkSize, job);
+        return;
+    }
+    // Same chunks as the job system would make, run in order
+    for (int begin = 0; begin < count; begin += chunkSize) {
+        job(begin, std::min(begin + chunkSize, count));
+    }
+}
+
+// FNV-1a over the raw bytes of each value
+static void hashBytes(unsigned long long& hash, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+}
+
+unsigned long long SimWorld::stateHash() const {
+    unsigned long long hash = 14695981039346656037ull;
+    hashBytes(hash, &tick, sizeof(tick));
+    hashBytes(hash, &matchOver, sizeof(matchOver));
+    hashBytes(hash, &winnerId, sizeof(winnerId));
+
+    // In deterministic mode only the fixed-point state is authoritative; the
+    // float copies are for rendering and may round differently per compiler
+    for (int p = 0; p < entities.size(); p++) {
+        const PlayerBody& body = entities.bodies[p];
+        const Player& player = entities.players[p];
+        hashBytes(hash, &body.id, sizeof(body.id));
+        if (deterministic) {
+            hashBytes(hash, &body.fixedX, sizeof(body.fixedX));
+            hashBytes(hash, &body.fixedY, sizeof(body.fixedY));
+            hashBytes(hash, &player.fixedAngle, sizeof(player.fixedAngle));
+        } else {
+            hashBytes(hash, &body.x, sizeof(body.x));
+            hashBytes(hash, &body.y, sizeof(body.y));
+            hashBytes(hash, &player.aimX, sizeof(player.aimX));
+            hashBytes(hash, &player.aimY, sizeof(player.aimY));
+        }
+        hashBytes(hash, &body.isAlive, sizeof(body.isAlive));
+    }
+
+    int count = bullets.count;
+    hashBytes(hash, &count, sizeof(count));
+    if (count > 0 && deterministic) {
+        hashBytes(hash, bullets.fixedX.data(), count * sizeof(Fixed));
+        hashBytes(hash, bullets.fixedY.data(), count * sizeof(Fixed));
+        hashBytes(hash, bullets.fixedVX.data(), count * sizeof(Fixed));
+        hashBytes(hash, bullets.fixedVY.data(), count * sizeof(Fixed));
+        hashBytes(hash, bullets.fixedLifetime.data(), count * sizeof(Fixed));
+        hashBytes(hash, bullets.fixedExpiry.data(), count * sizeof(Fixed));
+        hashBytes(hash, bullets.owner.data(), count * sizeof(int));
+    } else if (count > 0) {
+        hashBytes(hash, bullets.x.data(), count * sizeof(float));
+        hashBytes(hash, bullets.y.data(), count * sizeof(float));
+        hashBytes(hash, bullets.vx.data(), count * sizeof(float));
+        hashBytes(hash, bullets.vy.data(), count * sizeof(float));
+        hashBytes(hash, bullets.lifetime.data(), count * sizeof(float));
+        hashBytes(hash, bullets.expiry.data(), count * sizeof(float));
+        hashBytes(hash, bullets.owner.data(), count * sizeof(int));
+    }
+    if (count > 0) {
+        hashBytes(hash, bullets.rewind.data(), count * sizeof(Fixed));
+    }
+    return hash;
+}
+
+RandomStream SimWorld::random(RandomSubsystem subsystem, unsigned int entity) const {
+    return RandomStream(seed, (unsigned int)subsystem, entity, tick);
+}
+
+EntityHandle SimWorld::addPlayer(const PlayerBody& body, const Player& player) {
+    EntityHandle handle = entities.create(body, player);
+    rebuildAliveSet();
+    return handle;
+}
+
+bool SimWorld::removePlayer(EntityHandle handle) {
+    if (!entities.destroy(handle)) return false;
+    rebuildAliveSet();
+    return true;
+}
+
+Player* SimWorld::getPlayer(EntityHandle handle) {
+    return entities.get(handle);
+}
+
+PlayerBody* SimWorld::getBody(EntityHandle handle) {
+    return entities.body(handle);
+}
+
+int SimWorld::findPlayer(int id) const {
+    return entities.indexOfId(id);
+}
+
+int SimWorld::aliveCount() const {
+    return (int)alivePlayers.size();
+}
+
+void SimWorld::eliminate(int index, int killerId) {
+    PlayerBody& victim = entities.bodies[index];
+    if (!victim.isAlive) return;
+    victim.eliminate();
+
+    // Swap-remove from the alive set
+    int slot = aliveSlot[index];
+    int last = alivePlayers.back();
+    alivePlayers[slot] = last;
+    aliveSlot[last] = slot;
+    alivePlayers.pop_back();
+    aliveSlot[index] = -1;
+
+    int killer = findPlayer(killerId);
+    if (killer >= 0) {
+        entities.players[killer].kills++;
+    }
+
+    EliminationEvent event;
+    event.tick = tick;
+    event.victimId = victim.id;
+    event.killerId = killerId;
+    eliminations.push_back(event);
+    std::cout << "Player " << victim.id << " eliminated by Player " << killerId << "!\n";
+}
+
+void SimWorld::rebuildAliveSet() {
+    int playerCount = entities.size();
+    alivePlayers.clear();
+    aliveSlot.assign(playerCount, -1);
+    for (int p = 0; p < playerCount; p++) {
+        if (entities.bodies[p].isAlive) {
+            aliveSlot[p] = (int)alivePlayers.size();
+            alivePlayers.push_back(p);
+        }
+    }
+}
+
+void SimWorld::discardEventsFrom(unsigned int tick) {
+    while (!eliminations.empty() && eliminations.back().tick >= tick) {
+        eliminations.pop_back();
+    }
+}
+
+void SimWorld::spawnPlayers() {
+    // The map baked well-separated points when it loaded; hand them out in
+    // order, rotated by a random amount so matches start differently
+    int playerCount = entities.size();
+    unsigned int rotation = random(RANDOM_SPAWN, 0).next();
+    for (int i = 0; i < playerCount; i++) {
+        PlayerBody& body = entities.bodies[i];
+        Fixed spawnX, spawnY;
+        if (gameMap->spawnPoints.size() > 0) {
+            gameMap->spawnPoints.pick(*gameMap, i, playerCount, rotation, spawnX, spawnY);
+        } else {
+            // No free floor anywhere; the center is as good as any
+            spawnX = toFixed(width / 2.0f);
+            spawnY = toFixed(height / 2.0f);
+        }
+        body.fixedX = spawnX;
+        body.fixedY = spawnY;
+        body.x = fromFixed(spawnX);
+        body.y = fromFixed(spawnY);
+        entities.players[i].prevX = body.x;
+        entities.players[i].prevY = body.y;
+    }
+}
+
+void SimWorld::reset() {
+    for (PlayerBody& body : entities.bodies) {
+        body.isAlive = true;
+    }
+    for (Player& player : entities.players) {
+        player.kills = 0;
+    }
+    rebuildAliveSet();
+    eliminations.clear();
+    clearBullets();
+    history.clear();
+    tick = 0;
+    matchOver = false;
+    winnerId = -1;
+}
+
+void SimWorld::clearBullets() {
+    bullets.clear();
+}
+
+void SimWorld::clearPlayers(EntityHandle keep) {
+    std::vector<EntityHandle> kept;
+    kept.push_back(keep);
+    retainPlayers(kept);
+}
+
+void SimWorld::retainPlayers(const std::vector<EntityHandle>& keep) {
+    // Walk backwards: destroy() swaps the last entity into the freed slot
+    for (int i = entities.size() - 1; i >= 0; i--) {
+        EntityHandle handle = entities.denseHandle[i];
+        if (std::find(keep.begin(), keep.end(), handle) == keep.end()) {
+            entities.destroy(handle);
+        }
+    }
+    rebuildAliveSet();
+}
+
+void SimWorld::spawnBullet(const PlayerBody& body, const Player& shooter, float viewDelay) {
+    int i;
+    if (deterministic) {
+        Fixed spawnX, spawnY;
+        shooter.getBulletSpawnPositionFixed(body, spawnX, spawnY);
+        i = bullets.spawnFixed(spawnX, spawnY, shooter.fixedAngle, body.id, 600 * FIXED_ONE);
+    } else {
+        float spawnX, spawnY;
+        shooter.getBulletSpawnPosition(body, spawnX, spawnY);
+        i = bullets.spawn(spawnX, spawnY, shooter.aimX, shooter.aimY, body.id);
+    }
+
+    if (i < 0) return;
+    scheduleWallHit(i);
+
+    if (viewDelay > 0.0f) {
+        // Never further back than the history reaches
+        float maxDelay = (float)(history.capacity - 1);
+        bullets.rewind[i] = toFixed(std::min(viewDelay, maxDelay));
+    }
+}
+
+static int ticksToReach(float distance, float step) {
+    return std::max(1, (int)std::ceil(distance / step));
+}
+
+static float exitDistance(float start, float dir, float limit) {
+    if (dir > 0.0f) return (limit - start) / dir;
+    if (dir < 0.0f) return -start / dir;
+    return 1e30f;
+}
+
+void SimWorld::scheduleWallHit(int i) {
+    // Bullets fly straight and the map never changes, so the first wall or
+    // map edge on the path is known now; the bullet dies on the first tick
+    // that ends at or past it
+    if (deterministic) {
+        Fixed x = bullets.fixedX[i];
+        Fixed y = bullets.fixedY[i];
+        // Per-tick displacement; squaring the velocity itself would overflow
+        Fixed stepX = fixedMul(bullets.fixedVX[i], fixedDt);
+        Fixed stepY = fixedMul(bullets.fixedVY[i], fixedDt);
+        Fixed step = fixedSqrt(fixedMul(stepX, stepX) + fixedMul(stepY, stepY));
+        if (step <= 0) return;
+
+        Fixed maxLifetime = toFixed(bullets.maxLifetime);
+        int maxTicks = (int)((maxLifetime + fixedDt - 1) / fixedDt);
+        Fixed range = step * maxTicks;
+        Fixed dirX = fixedDiv(stepX, step);
+        Fixed dirY = fixedDiv(stepY, step);
+        if (dirX > 0) range = std::min(range, fixedDiv(toFixed(width) - x, dirX));
+        if (dirX < 0) range = std::min(range, fixedDiv(-x, dirX));
+        if (dirY > 0) range = std::min(range, fixedDiv(toFixed(height) - y, dirY));
+        if (dirY < 0) range = std::min(range, fixedDiv(-y, dirY));
+        if (gameMap != nullptr) {
+            range = gameMap->castCircleFixed(x, y, toFixed(bullets.size), dirX, dirY, std::max(range, (Fixed)0));
+        }
+
+        int ticks = std::max(1, (int)((range + step - 1) / step));
+        if (ticks < maxTicks) {
+            bullets.fixedExpiry[i] = ticks * fixedDt;
+        }
+    } else {
+        float speed = std::sqrt(bullets.vx[i] * bullets.vx[i] + bullets.vy[i] * bullets.vy[i]);
+        float step = speed * dt;
+        if (step <= 0.0f) return;
+
+        float dirX = bullets.vx[i] / speed;
+        float dirY = bullets.vy[i] / speed;
+        float range = speed * bullets.maxLifetime;
+        range = std::min(range, exitDistance(bullets.x[i], dirX, width));
+        range = std::min(range, exitDistance(bullets.y[i], dirY, height));
+        if (gameMap != nullptr) {
+            range = gameMap->castCircle(bullets.x[i], bullets.y[i], bullets.size, dirX, dirY, std::max(range, 0.0f));
+        }
+
+        // Half a tick early so lifetime's rounding can't cost an extra tick
+        float expiry = (ticksToReach(range, step) - 0.5f) * dt;
+        bullets.expiry[i] = std::min(bullets.maxLifetime, expiry);
+    }
+}
+
+void SimWorld::movePlayers(const std::vector<PlayerInput>& inputs) {
+    // Match inputs to players up front so the parallel part only reads them.
+    // Walk backwards so a player's first input wins if it sent several.
+    int playerCount = entities.size();
+    playerMoves.assign(playerCount, InputCmd());
+    for (int i = (int)inputs.size() - 1; i >= 0; i--) {
+        int p = findPlayer(inputs[i].playerId);
+        if (p >= 0) {
+            playerMoves[p] = inputs[i];
+        }
+    }
+
+    // Each player only moves itself against the static map
+    parallelFor(playerCount, PLAYER_CHUNK, [this](int begin, int end) {
+        for (int p = begin; p < end; p++) {
+            PlayerBody& body = entities.bodies[p];
+            if (!body.isAlive) continue;
+            if (deterministic) {
+                body.updateMovementFixed(playerMoves[p], gameMap, fixedDt);
+            } else {
+                body.updateMovementWithCollision(playerMoves[p], gameMap, dt);
+            }
+        }
+    });
+}
+
+void SimWorld::separatePlayers() {
+    int playerCount = entities.size();
+    float maxPlayerSize = 0.0f;
+    for (const PlayerBody& body : entities.bodies) {
+        if (body.isAlive) {
+            maxPlayerSize = std::max(maxPlayerSize, body.size);
+        }
+    }
+    // Two players touch when their centers are within the sum of their radii;
+    // the extra unit covers deterministic mode testing fixed-point positions
+    float reach = maxPlayerSize + 1.0f;
+
+    // Gather every player's push from the positions after movement. Nothing
+    // moves yet, so the result doesn't depend on order or thread count.
+    if (deterministic) {
+        fixedPushX.assign(playerCount, 0);
+        fixedPushY.assign(playerCount, 0);
+    } else {
+        pushX.assign(playerCount, 0.0f);
+        pushY.assign(playerCount, 0.0f);
+    }
+    parallelFor(playerCount, PLAYER_CHUNK, [this, reach](int begin, int end) {
+        static thread_local std::vector<int> candidates;
+        for (int p = begin; p < end; p++) {
+            const PlayerBody& body = entities.bodies[p];
+            if (!body.isAlive) continue;
+            candidates.clear();
+            playerGrid.query(body.x, body.y, reach, candidates);
+
+            if (deterministic) {
+                Fixed totalX = 0, totalY = 0;
+                for (int q : candidates) {
+                    const PlayerBody& other = entities.bodies[q];
+                    if (q == p || !other.isAlive) continue;
+                    Fixed dx = body.fixedX - other.fixedX;
+                    Fixed dy = body.fixedY - other.fixedY;
+                    Fixed contact = toFixed((body.size + other.size) / 2.0f);
+                    // Cheap box reject before the square root
+                    if (dx >= contact || -dx >= contact || dy >= contact || -dy >= contact) continue;
+                    Fixed distance = fixedLength(dx, dy);
+                    if (distance >= contact) continue;
+
+                    Fixed half = (contact - distance) / 2;
+                    if (distance > 0) {
+                        totalX += fixedMul(fixedDiv(dx, distance), half);
+                        totalY += fixedMul(fixedDiv(dy, distance), half);
+                    } else {
+                        // Same spot: split along x, lower index to the left
+                        totalX += p < q ? -half : half;
+                    }
+                }
+                Fixed maxPush = toFixed(body.size / 2.0f);
+                Fixed length = fixedLength(totalX, totalY);
+                if (length > maxPush) {
+                    totalX = fixedMul(totalX, fixedDiv(maxPush, length));
+                    totalY = fixedMul(totalY, fixedDiv(maxPush, length));
+                }
+                fixedPushX[p] = totalX;
+                fixedPushY[p] = totalY;
+                continue;
+            }
+
+            float totalX = 0.0f, totalY = 0.0f;
+            for (int q : candidates) {
+                const PlayerBody& other = entities.bodies[q];
+                if (q == p || !other.isAlive) continue;
+                float dx = body.x - other.x;
+                float dy = body.y - other.y;
+                float contact = (body.size + other.size) / 2.0f;
+                float distanceSquared = dx * dx + dy * dy;
+                if (distanceSquared >= contact * contact) continue;
+
+                float distance = std::sqrt(distanceSquared);
+                float half = (contact - distance) / 2.0f;
+                if (distance > 0.0f) {
+                    totalX += dx / distance * half;
+                    totalY += dy / distance * half;
+                } else {
+                    totalX += p < q ? -half : half;
+                }
+            }
+            float maxPush = body.size / 2.0f;
+            float lengthSquared = totalX * totalX + totalY * totalY;
+            if (lengthSquared > maxPush * maxPush) {
+                float scale = maxPush / std::sqrt(lengthSquared);
+                totalX *= scale;
+                totalY *= scale;
+            }
+            pushX[p] = totalX;
+            pushY[p] = totalY;
+        }
+    });
+
+    // Apply the pushes through the map so nobody is shoved into a wall
+    parallelFor(playerCount, PLAYER_CHUNK, [this](int begin, int end) {
+        for (int p = begin; p < end; p++) {
+            PlayerBody& body = entities.bodies[p];
+            if (!body.isAlive) continue;
+            if (deterministic) {
+                if (fixedPushX[p] == 0 && fixedPushY[p] == 0) continue;
+                if (gameMap != nullptr) {
+                    gameMap->moveCircleFixed(body.fixedX, body.fixedY, toFixed(body.size / 2.0f), fixedPushX[p], fixedPushY[p]);
+                } else {
+                    body.fixedX += fixedPushX[p];
+                    body.fixedY += fixedPushY[p];
+                }
+                body.x = fromFixed(body.fixedX);
+                body.y = fromFixed(body.fixedY);
+            } else {
+                if (pushX[p] == 0.0f && pushY[p] == 0.0f) continue;
+                if (gameMap != nullptr) {
+                    gameMap->moveCircle(body.x, body.y, body.size / 2.0f, pushX[p], pushY[p]);
+                } else {
+                    body.x += pushX[p];
+                    body.y += pushY[p];
+                }
+            }
+        }
+    });
+}
+
+void SimWorld::updateBullets() {
+    // Walls and map edges were resolved in spawnBullet(), so this is only
+    // movement and expiry. Chunks start on multiples of 32, so kill() in one
+    // chunk never touches the deadMask word of another
+    parallelFor(bullets.count, BULLET_CHUNK, [this](int begin, int end) {
+        if (deterministic) {
+            bullets.updateFixedRange(begin, end, fixedDt);
+        } else {
+            bullets.updateRange(begin, end, dt);
+        }
+    });
+}
+
+void SimWorld::buildPlayerGrid() {
+    playerGrid.begin();
+    for (int p = 0; p < entities.size(); p++) {
+        const PlayerBody& body = entities.bodies[p];
+        if (body.isAlive) {
+            playerGrid.insert(p, body.x, body.y);
+        }
+    }
+    playerGrid.finish();
+}
+
+void SimWorld::checkBulletCollisions() {
+    float maxPlayerRadius = 0.0f;
+    float maxPlayerStep = 0.0f;
+    for (const PlayerBody& body : entities.bodies) {
+        if (body.isAlive) {
+            maxPlayerRadius = std::max(maxPlayerRadius, body.size / 2.0f);
+            maxPlayerStep = std::max(maxPlayerStep, body.speed * dt);
+        }
+    }
+    // The grid was built before separation, which moves a player at most its
+    // radius. It works on float positions; in deterministic mode the exact
+    // test uses fixed point, so leave room for the difference
+    float reach = maxPlayerRadius * 2.0f + bullets.size + (deterministic ? 1.0f : 0.0f);
+    // The grid holds current positions, so a rewound target can be up to one
+    // step per rewound tick away from its cell (plus slack for wall push-out
+    // and quantization)
+    float rewindReach = maxPlayerStep + 1.0f;
+
+    // Find every bullet's target in parallel against the players alive at the
+    // start of the phase; nothing is modified yet
+    bulletHits.resize(bullets.count);
+    parallelFor(bullets.count, BULLET_CHUNK, [this, reach, rewindReach](int begin, int end) {
+        static thread_local std::vector<int> candidates;
+        for (int i = begin; i < end; i++) {
+            bulletHits[i] = bullets.active[i] ? findBulletHit(i, reach, rewindReach, candidates) : -1;
+        }
+    });
+
+    // Apply hits in bullet order. A target eliminated by an earlier bullet this
+    // tick is looked up again, exactly as a serial pass would see it.
+    for (int i = 0; i < bullets.count; i++) {
+        int hitIndex = bulletHits[i];
+        if (hitIndex == -1) continue;
+        if (!entities.bodies[hitIndex].isAlive) {
+            hitIndex = findBulletHit(i, reach, rewindReach, gridCandidates);
+            if (hitIndex == -1) continue;
+        }
+
+        eliminate(hitIndex, bullets.owner[i]);
+        bullets.kill(i);
+    }
+}
+
+int SimWorld::findBulletHit(int i, float reach, float rewindReach, std::vector<int>& candidates) const {
+    Fixed rewind = bullets.rewind[i];
+    if (rewind > 0) {
+        reach += fromFixed(rewind) * rewindReach;
+    }
+    candidates.clear();
+    playerGrid.query(bullets.x[i], bullets.y[i], reach, candidates);
+
+    // Keep the lowest player index so results match scanning players in order
+    int hitIndex = -1;
+    for (int p : candidates) {
+        if (hitIndex != -1 && p >= hitIndex) continue;
+
+        const PlayerBody* player = &entities.bodies[p];
+        if (!player->isAlive) continue;  // Eliminated earlier this tick
+        if (player->id == bullets.owner[i]) continue;
+
+        // Test against the target where the shooter saw it
+        Fixed targetX, targetY;
+        bool rewound = rewind > 0 && history.rewind(p, tick, rewind, targetX, targetY);
+
+        if (deterministic) {
+            if (!rewound) {
+                targetX = player->fixedX;
+                targetY = player->fixedY;
+            }
+            long long dx = bullets.fixedX[i] - targetX;
+            long long dy = bullets.fixedY[i] - targetY;
+            long long hitRadius = toFixed(player->size / 2.0f + bullets.size);
+            if (dx * dx + dy * dy < hitRadius * hitRadius) {
+                hitIndex = p;
+            }
+            continue;
+        }
+
+        float dx = bullets.x[i] - (rewound ? fromFixed(targetX) : player->x);
+        float dy = bullets.y[i] - (rewound ? fromFixed(targetY) : player->y);
+        float hitRadius = player->size / 2.0f + bullets.size;
+
+        if (dx * dx + dy * dy < hitRadius * hitRadius) {
+            hitIndex = p;
+        }
+    }
+    return hitIndex;
+}
+
+void SimWorld::cleanupBullets() {
+    bullets.compact();
+}
+
+void SimWorld::checkWinCondition() {
+    if (aliveCount() <= 1 && entities.size() > 1) {
+        const PlayerBody* lastAlive = alivePlayers.empty() ? nullptr : &entities.bodies[alivePlayers[0]];
+        matchOver = true;
+        winnerId = (lastAlive != nullptr) ? lastAlive->id : -1;
+        std::cout << "Match ended! ";
+        if (lastAlive != nullptr) {
+            std::cout << "Player " << lastAlive->id << " wins!\n";
+        }
+    }
+}
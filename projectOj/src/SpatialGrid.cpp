@@ -0,0 +1,120 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid::SpatialGrid(float cellSize, int tableSize)
+    : cellSize(cellSize), tableSize(tableSize), bucketStart(tableSize + 1, 0) {
+}
+
+int SpatialGrid::cellCoord(float v) const {
+    return (int)std::floor(v / cellSize);
+}
+
+int SpatialGrid::bucket(int cellX, int cellY) const {
+    // Large primes spread neighbouring cells across the table
+    unsigned int h = (unsigned int)cellX * 73856093u ^ (unsigned int)cellY * 19349663u;
+    return (int)(h & (unsigned int)(tableSize - 1));
+}
+
+void SpatialGrid::begin() {
+    pendingItem.clear();
+    pendingBucket.clear();
+}
+
+void SpatialGrid::insert(int item, float x, float y) {
+    pendingItem.push_back(item);
+    pendingBucket.push_back(bucket(cellCoord(x), cellCoord(y)));
+}
+
+void SpatialGrid::finish() {
+    int n = (int)pendingItem.size();
+
+    // Count items per bucket, then turn counts into start offsets
+    for (int b = 0; b <= tableSize; b++) {
+        bucketStart[b] = 0;
+    }
+    for (int i = 0; i < n; i++) {
+        bucketStart[pendingBucket[i] + 1]++;
+    }
+    for (int b = 0; b < tableSize; b++) {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+
+    // Scatter; insertion order is kept within a bucket
+    items.resize(n);
+    std::vector<int>& cursor = pendingBucket;
+    for (int i = 0; i < n; i++) {
+        int b = cursor[i];
+        cursor[i] = bucketStart[b]++;
+    }
+    for (int i = 0; i < n; i++) {
+        items[cursor[i]] = pendingItem[i];
+    }
+
+    // The scatter advanced each start to the next bucket's start; shift back
+    for (int b = tableSize; b > 0; b--) {
+        bucketStart[b] = bucketStart[b - 1];
+    }
+    bucketStart[0] = 0;
+}
+
+void SpatialGrid::query(float x, float y, float radius, std::vector<int>& out) const {
+    int minX = cellCoord(x - radius);
+    int maxX = cellCoord(x + radius);
+    int minY = cellCoord(y - radius);
+    int maxY = cellCoord(y + radius);
+
+    // A box covering at least as many cells as there are buckets reads
+    // (almost) the whole table anyway; hand back every item once
+    double cellCount = ((double)maxX - minX + 1) * ((double)maxY - minY + 1);
+    if (cellCount >= tableSize) {
+        out.insert(out.end(), items.begin(), items.end());
+        return;
+    }
+
+    // Remember visited buckets so cells that hash together aren't read twice.
+    // Small boxes keep the list on the stack; larger ones stamp a per-thread
+    // table, since queries run in parallel on the same grid.
+    const int maxVisited = 16;
+    int visited[maxVisited];
+    int visitedCount = 0;
+    bool small = cellCount <= maxVisited;
+
+    static thread_local std::vector<unsigned int> stamps;
+    static thread_local unsigned int stamp = 0;
+    if (!small) {
+        if ((int)stamps.size() < tableSize) {
+            stamps.assign(tableSize, 0);
+            stamp = 0;
+        }
+        if (++stamp == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            stamp = 1;
+        }
+    }
+
+    for (int cy = minY; cy <= maxY; cy++) {
+        for (int cx = minX; cx <= maxX; cx++) {
+            int b = bucket(cx, cy);
+
+            if (small) {
+                bool seen = false;
+                for (int v = 0; v < visitedCount; v++) {
+                    if (visited[v] == b) {
+                        seen = true;
+                        break;
+                    }
+                }
+                if (seen) continue;
+                visited[visitedCount++] = b;
+            } else {
+                if (stamps[b] == stamp) continue;
+                stamps[b] = stamp;
+            }
+
+            for (int i = bucketStart[b]; i < bucketStart[b + 1]; i++) {
+                out.push_back(items[i]);
+            }
+        }
+    }
+}
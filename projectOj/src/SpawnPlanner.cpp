@@ -0,0 +1,194 @@
+#include "SpawnPlanner.h"
+#include "Map.h"
+#include <algorithm>
+
+// Small fixed-seed generator; std:: engines' distributions differ between
+// standard libraries
+static unsigned int nextRandom(unsigned int& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static long long distanceSquared(Fixed ax, Fixed ay, Fixed bx, Fixed by) {
+    long long dx = (long long)ax - bx;
+    long long dy = (long long)ay - by;
+    return dx * dx + dy * dy;
+}
+
+SpawnPlanner::SpawnPlanner() : playerRadius(0) {
+}
+
+void SpawnPlanner::build(const Map& map, float spacing, float playerRadius) {
+    this->playerRadius = toFixed(playerRadius);
+    tiers.clear();
+
+    // Halving the area per point doubles the points. Stop at touching
+    // players first, then at overlapping by half; a step that lands just
+    // short of either snaps to it instead of baking a near-copy tier.
+    const Fixed halfArea = 46341;   // 1 / sqrt(2)
+    Fixed touching = this->playerRadius * 2;
+    Fixed tierSpacing = toFixed(spacing);
+    while (true) {
+        tiers.push_back(SpawnTier());
+        SpawnTier& tier = tiers.back();
+        tier.spacing = tierSpacing;
+        sample(map, tier);
+        orderFarthestFirst(tier, toFixed(map.width / 2.0f), toFixed(map.height / 2.0f));
+        if (tierSpacing <= this->playerRadius) break;
+
+        Fixed floor = tierSpacing > touching ? touching : this->playerRadius;
+        Fixed next = fixedMul(tierSpacing, halfArea);
+        tierSpacing = next - floor < this->playerRadius / 8 ? floor : next;
+    }
+}
+
+int SpawnPlanner::size() const {
+    return tiers.empty() ? 0 : tiers[0].size();
+}
+
+int SpawnPlanner::tierFor(int count) const {
+    for (int t = 0; t < (int)tiers.size(); t++) {
+        if (tiers[t].size() >= count) return t;
+    }
+    return (int)tiers.size() - 1;
+}
+
+void SpawnPlanner::sample(const Map& map, SpawnTier& tier) const {
+    std::vector<Fixed>& x = tier.x;
+    std::vector<Fixed>& y = tier.y;
+    Fixed spacing = tier.spacing;
+    x.clear();
+    y.clear();
+    if (spacing <= 0) return;
+
+    // Background grid with cells of spacing / sqrt(2): at most one point per
+    // cell, and every point closer than spacing lies within two cells
+    Fixed cell = fixedDiv(spacing, 92682);  // sqrt(2) in 16.16
+    Fixed maxX = toFixed(map.width);
+    Fixed maxY = toFixed(map.height);
+    int columns = maxX / cell + 1;
+    int rows = maxY / cell + 1;
+    std::vector<int> grid((size_t)columns * rows, -1);
+    long long minDistanceSquared = (long long)spacing * spacing;
+
+    unsigned int random = 0x9E3779B9u;
+    std::vector<int> active;
+
+    // Accept (px, py) if it is free floor and no point is too close
+    auto tryAdd = [&](Fixed px, Fixed py) {
+        if (px < 0 || py < 0 || px >= maxX || py >= maxY) return false;
+        int cx = px / cell;
+        int cy = py / cell;
+        for (int gy = std::max(cy - 2, 0); gy <= std::min(cy + 2, rows - 1); gy++) {
+            for (int gx = std::max(cx - 2, 0); gx <= std::min(cx + 2, columns - 1); gx++) {
+                int other = grid[(size_t)gy * columns + gx];
+                if (other != -1 && distanceSquared(px, py, x[other], y[other]) < minDistanceSquared) {
+                    return false;
+                }
+            }
+        }
+        if (!map.isValidSpawnPositionFixed(px, py, playerRadius)) return false;
+
+        grid[(size_t)cy * columns + cx] = (int)x.size();
+        active.push_back((int)x.size());
+        x.push_back(px);
+        y.push_back(py);
+        return true;
+    };
+
+    // Seeds on a coarse lattice reach floor that obstacles cut off from the
+    // first seed's region; most are rejected as already covered
+    for (Fixed seedY = spacing; seedY < maxY; seedY += spacing * 2) {
+        for (Fixed seedX = spacing; seedX < maxX; seedX += spacing * 2) {
+            if (!tryAdd(seedX, seedY)) continue;
+
+            while (!active.empty()) {
+                int slot = (int)(nextRandom(random) % active.size());
+                int from = active[slot];
+                bool added = false;
+                for (int k = 0; k < CANDIDATES && !added; k++) {
+                    int angle = (int)(nextRandom(random) & ANGLE_MASK);
+                    Fixed distance = spacing + (Fixed)(((long long)spacing * (nextRandom(random) & 0xFFFF)) >> 16);
+                    added = tryAdd(x[from] + fixedMul(fixedCos(angle), distance),
+                                   y[from] + fixedMul(fixedSin(angle), distance));
+                }
+                if (!added) {
+                    active[slot] = active.back();
+                    active.pop_back();
+                }
+            }
+        }
+    }
+}
+
+void SpawnPlanner::orderFarthestFirst(SpawnTier& tier, Fixed centerX, Fixed centerY) const {
+    std::vector<Fixed>& x = tier.x;
+    std::vector<Fixed>& y = tier.y;
+    int count = tier.size();
+    if (count == 0) return;
+
+    // Greedy farthest-point traversal, starting next to the map center. Each
+    // prefix is within a factor of two of the best possible separation.
+    std::vector<long long> nearest(count);
+    int first = 0;
+    for (int i = 0; i < count; i++) {
+        nearest[i] = distanceSquared(x[i], y[i], centerX, centerY);
+        if (nearest[i] < nearest[first]) first = i;
+    }
+
+    std::vector<Fixed> orderedX, orderedY;
+    orderedX.reserve(count);
+    orderedY.reserve(count);
+    std::vector<bool> taken(count, false);
+    int next = first;
+    for (int n = 0; n < count; n++) {
+        taken[next] = true;
+        orderedX.push_back(x[next]);
+        orderedY.push_back(y[next]);
+
+        int farthest = -1;
+        for (int i = 0; i < count; i++) {
+            if (taken[i]) continue;
+            long long d = distanceSquared(x[i], y[i], x[next], y[next]);
+            if (n == 0 || d < nearest[i]) nearest[i] = d;
+            if (farthest == -1 || nearest[i] > nearest[farthest]) farthest = i;
+        }
+        next = farthest;
+    }
+    x.swap(orderedX);
+    y.swap(orderedY);
+}
+
+void SpawnPlanner::pick(const Map& map, int index, int count, unsigned int rotation, Fixed& outX, Fixed& outY) const {
+    const SpawnTier* tier = tiers.empty() ? nullptr : &tiers[tierFor(count)];
+    int used = tier != nullptr ? std::min(count, tier->size()) : 0;
+    if (used <= 0) {
+        outX = 0;
+        outY = 0;
+        return;
+    }
+    int point = (int)(((unsigned int)index + rotation) % (unsigned int)used);
+    const std::vector<Fixed>& x = tier->x;
+    const std::vector<Fixed>& y = tier->y;
+    outX = x[point];
+    outY = y[point];
+
+    // More players than points even in the densest tier: put later laps a
+    // player's width off the point, turning by the golden angle per lap and
+    // trying the other directions until one is free floor
+    int lap = index / used;
+    if (lap == 0) return;
+    Fixed offset = playerRadius * 2;
+    for (int turn = 0; turn < 8; turn++) {
+        int angle = (lap * 40503 + turn * (ANGLE_TURN / 8)) & ANGLE_MASK;
+        Fixed candidateX = x[point] + fixedMul(fixedCos(angle), offset);
+        Fixed candidateY = y[point] + fixedMul(fixedSin(angle), offset);
+        if (map.isValidSpawnPositionFixed(candidateX, candidateY, playerRadius)) {
+            outX = candidateX;
+            outY = candidateY;
+            return;
+        }
+    }
+}
@@ -0,0 +1,188 @@
+#include "WorldSnapshot.h"
+#include "SimWorld.h"
+#include "Player.h"
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<PlayerBody>::value, "PlayerBody is snapshotted with memcpy");
+static_assert(std::is_trivially_copyable<Player>::value, "Player is snapshotted with memcpy");
+
+struct SnapshotHeader {
+    unsigned int tick;
+    int winnerId;
+    int playerCount;
+    int slotCount;          // Entries in the sparse slot table
+    int freeCount;
+    int bulletCount;
+    bool matchOver;
+};
+
+// Bytes per live bullet over every array the tick reads
+static const size_t BULLET_BYTES = 8 * sizeof(float) + sizeof(int) + sizeof(unsigned char) + 7 * sizeof(Fixed);
+
+// Append / consume one array at the cursor
+static void put(unsigned char*& cursor, const void* data, size_t size) {
+    if (size == 0) return;  // data() of an empty vector may be null
+    std::memcpy(cursor, data, size);
+    cursor += size;
+}
+
+static void take(const unsigned char*& cursor, void* data, size_t size) {
+    if (size == 0) return;
+    std::memcpy(data, cursor, size);
+    cursor += size;
+}
+
+template <typename T>
+static void takeVector(const unsigned char*& cursor, std::vector<T>& out, int count) {
+    out.resize(count);  // No allocation once the world has held this many
+    take(cursor, out.data(), count * sizeof(T));
+}
+
+WorldSnapshot::WorldSnapshot() : tick(0), size(0) {
+}
+
+size_t WorldSnapshot::bytesNeeded(int players, int slots, int bullets) {
+    return sizeof(SnapshotHeader) +
+           players * (sizeof(PlayerBody) + sizeof(Player) + sizeof(EntityHandle)) +
+           slots * (sizeof(int) + sizeof(unsigned int)) +
+           slots * sizeof(unsigned int) +           // Free list is at most one entry per slot
+           bullets * BULLET_BYTES;
+}
+
+void WorldSnapshot::reserve(int maxPlayers, int maxBullets) {
+    size_t needed = bytesNeeded(maxPlayers, maxPlayers, maxBullets);
+    if (bytes.size() < needed) {
+        bytes.resize(needed);
+    }
+}
+
+void WorldSnapshot::capture(const SimWorld& world) {
+    const EntityStore& entities = world.entities;
+    const BulletPool& bullets = world.bullets;
+
+    SnapshotHeader header;
+    header.tick = world.tick;
+    header.winnerId = world.winnerId;
+    header.matchOver = world.matchOver;
+    header.playerCount = entities.size();
+    header.slotCount = (int)entities.slotDense.size();
+    header.freeCount = (int)entities.freeSlots.size();
+    header.bulletCount = bullets.count;
+
+    size_t needed = bytesNeeded(header.playerCount, header.slotCount, header.bulletCount);
+    if (bytes.size() < needed) {
+        bytes.resize(needed);   // Only if reserve() was too small
+    }
+
+    int n = header.bulletCount;
+    unsigned char* cursor = bytes.data();
+    put(cursor, &header, sizeof(header));
+    put(cursor, entities.bodies.data(), header.playerCount * sizeof(PlayerBody));
+    put(cursor, entities.players.data(), header.playerCount * sizeof(Player));
+    put(cursor, entities.denseHandle.data(), header.playerCount * sizeof(EntityHandle));
+    put(cursor, entities.slotDense.data(), header.slotCount * sizeof(int));
+    put(cursor, entities.slotGeneration.data(), header.slotCount * sizeof(unsigned int));
+    put(cursor, entities.freeSlots.data(), header.freeCount * sizeof(unsigned int));
+    put(cursor, bullets.x.data(), n * sizeof(float));
+    put(cursor, bullets.y.data(), n * sizeof(float));
+    put(cursor, bullets.prevX.data(), n * sizeof(float));
+    put(cursor, bullets.prevY.data(), n * sizeof(float));
+    put(cursor, bullets.vx.data(), n * sizeof(float));
+    put(cursor, bullets.vy.data(), n * sizeof(float));
+    put(cursor, bullets.lifetime.data(), n * sizeof(float));
+    put(cursor, bullets.expiry.data(), n * sizeof(float));
+    put(cursor, bullets.owner.data(), n * sizeof(int));
+    put(cursor, bullets.active.data(), n * sizeof(unsigned char));
+    put(cursor, bullets.fixedX.data(), n * sizeof(Fixed));
+    put(cursor, bullets.fixedY.data(), n * sizeof(Fixed));
+    put(cursor, bullets.fixedVX.data(), n * sizeof(Fixed));
+    put(cursor, bullets.fixedVY.data(), n * sizeof(Fixed));
+    put(cursor, bullets.fixedLifetime.data(), n * sizeof(Fixed));
+    put(cursor, bullets.fixedExpiry.data(), n * sizeof(Fixed));
+    put(cursor, bullets.rewind.data(), n * sizeof(Fixed));
+
+    tick = world.tick;
+    size = cursor - bytes.data();
+}
+
+void WorldSnapshot::restore(SimWorld& world) const {
+    EntityStore& entities = world.entities;
+    BulletPool& bullets = world.bullets;
+
+    SnapshotHeader header;
+    const unsigned char* cursor = bytes.data();
+    take(cursor, &header, sizeof(header));
+    world.tick = header.tick;
+    world.winnerId = header.winnerId;
+    world.matchOver = header.matchOver;
+
+    takeVector(cursor, entities.bodies, header.playerCount);
+    takeVector(cursor, entities.players, header.playerCount);
+    takeVector(cursor, entities.denseHandle, header.playerCount);
+    takeVector(cursor, entities.slotDense, header.slotCount);
+    takeVector(cursor, entities.slotGeneration, header.slotCount);
+    takeVector(cursor, entities.freeSlots, header.freeCount);
+
+    // The pool's arrays are sized to its capacity, so these never reallocate
+    int n = header.bulletCount;
+    bullets.count = n;
+    take(cursor, bullets.x.data(), n * sizeof(float));
+    take(cursor, bullets.y.data(), n * sizeof(float));
+    take(cursor, bullets.prevX.data(), n * sizeof(float));
+    take(cursor, bullets.prevY.data(), n * sizeof(float));
+    take(cursor, bullets.vx.data(), n * sizeof(float));
+    take(cursor, bullets.vy.data(), n * sizeof(float));
+    take(cursor, bullets.lifetime.data(), n * sizeof(float));
+    take(cursor, bullets.expiry.data(), n * sizeof(float));
+    take(cursor, bullets.owner.data(), n * sizeof(int));
+    take(cursor, bullets.active.data(), n * sizeof(unsigned char));
+    take(cursor, bullets.fixedX.data(), n * sizeof(Fixed));
+    take(cursor, bullets.fixedY.data(), n * sizeof(Fixed));
+    take(cursor, bullets.fixedVX.data(), n * sizeof(Fixed));
+    take(cursor, bullets.fixedVY.data(), n * sizeof(Fixed));
+    take(cursor, bullets.fixedLifetime.data(), n * sizeof(Fixed));
+    take(cursor, bullets.fixedExpiry.data(), n * sizeof(Fixed));
+    take(cursor, bullets.rewind.data(), n * sizeof(Fixed));
+
+    // Between ticks nothing is marked dead: compact() has already run
+    std::fill(bullets.deadMask.begin(), bullets.deadMask.end(), 0u);
+
+    // Derived from the players; eliminations after the snapshot never happened
+    entities.rebuildIdIndex();
+    world.rebuildAliveSet();
+    world.discardEventsFrom(header.tick);
+}
+
+SnapshotRing::SnapshotRing(int capacity, int maxPlayers, int maxBullets)
+    : slots(capacity > 0 ? capacity : 1), used(slots.size(), false) {
+    for (WorldSnapshot& slot : slots) {
+        slot.reserve(maxPlayers, maxBullets);
+    }
+}
+
+void SnapshotRing::save(const SimWorld& world) {
+    int index = (int)(world.tick % slots.size());
+    slots[index].capture(world);
+    used[index] = true;
+}
+
+const WorldSnapshot* SnapshotRing::find(unsigned int tick) const {
+    int index = (int)(tick % slots.size());
+    if (!used[index] || slots[index].tick != tick) {
+        return nullptr;
+    }
+    return &slots[index];
+}
+
+bool SnapshotRing::restore(SimWorld& world, unsigned int tick) const {
+    const WorldSnapshot* snapshot = find(tick);
+    if (snapshot == nullptr) return false;
+    snapshot->restore(world);
+    return true;
+}
+
+int SnapshotRing::capacity() const {
+    return (int)slots.size();
+}